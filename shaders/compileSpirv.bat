@@ -0,0 +1,26 @@
+@echo off
+rem Compiles every shader stage to SPIR-V for System::SpirvLoader, in shaders\spirv.
+rem Needs glslangValidator, from the Vulkan SDK or the PATH. Without it the engine keeps
+rem compiling the GLSL at startup, so the build goes on.
+setlocal
+
+set SHADERS=%~dp0
+set OUTPUT=%SHADERS%spirv
+set GLSLANG=
+if defined VULKAN_SDK if exist "%VULKAN_SDK%\Bin\glslangValidator.exe" set GLSLANG="%VULKAN_SDK%\Bin\glslangValidator.exe"
+if not defined GLSLANG where /q glslangValidator && set GLSLANG=glslangValidator
+if not defined GLSLANG (
+    echo glslangValidator not found, shaders are only compiled from GLSL at runtime.
+    exit /b 0
+)
+
+if not exist "%OUTPUT%" mkdir "%OUTPUT%"
+
+rem -G targets OpenGL, which predefines GL_SPIRV; includes resolve from the including file
+for %%f in ("%SHADERS%*_vs.glsl") do (
+    %GLSLANG% -G -S vert -o "%OUTPUT%\%%~nf.spv" "%%f" || exit /b 1
+)
+for %%f in ("%SHADERS%*_fs.glsl") do (
+    %GLSLANG% -G -S frag -o "%OUTPUT%\%%~nf.spv" "%%f" || exit /b 1
+)
+exit /b 0
@@ -1,14 +1,34 @@
 #version 460 core
+#ifdef GL_SPIRV
+#extension GL_GOOGLE_include_directive : require
+#endif
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
-in vec3 myColor;
-in vec2 myTex;
+layout (location = 0) in vec3 myColor;
+layout (location = 1) in vec2 myTex;
+layout (location = 2) flat in float myFade;
 
-uniform sampler2D texture0;
+layout (location = 1) uniform sampler2D texture0;
+
+// Features, defines of the GLSL variants and specialization constants of the SPIR-V ones
+#ifdef GL_SPIRV
+layout (constant_id = 0) const bool VERTEX_COLOR_ONLY = false;
+#elif !defined(VERTEX_COLOR_ONLY)
+#define VERTEX_COLOR_ONLY 0
+#endif
+
+#include "include/dither.glsl"
 
 void main()
 {
-	FragColor = texture(texture0, myTex) * vec4(myColor, 5.0);
-	//FragColor = vec4(myColor, 1.0);
+	DitherFade(myFade);
+	if (bool(VERTEX_COLOR_ONLY))
+	{
+		FragColor = vec4(myColor, 1.0);
+	}
+	else
+	{
+		FragColor = texture(texture0, myTex) * vec4(myColor, 5.0);
+	}
 }
\ No newline at end of file
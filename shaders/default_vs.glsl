@@ -1,19 +1,24 @@
 #version 460 core
+#ifdef GL_SPIRV
+#extension GL_GOOGLE_include_directive : require
+#endif
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inColor;
 layout (location = 2) in vec2 inTexture;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "include/draw.glsl"
+#include "include/frame.glsl"
 
-out vec3 myColor;
-out vec2 myTex;
+layout (location = 0) out vec3 myColor;
+layout (location = 1) out vec2 myTex;
+layout (location = 2) flat out float myFade;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(inPosition, 1.0);
+	mat4 model = models[drawOffset + gl_DrawID];
+	gl_Position = viewProjection * model * vec4(inPosition, 1.0);
 	myColor = inColor;
 	myTex = inTexture;
+	myFade = fades[drawOffset + gl_DrawID];
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+// Ordered dither, levels of detail cross fading cover complementary pixels
+const float bayer[16] = float[16](
+	0.0, 8.0, 2.0, 10.0,
+	12.0, 4.0, 14.0, 6.0,
+	3.0, 11.0, 1.0, 9.0,
+	15.0, 7.0, 13.0, 5.0);
+
+// Discards the pixels a draw with the given fade leaves to the other level, see System::DrawRange::fade
+void DitherFade(float fade)
+{
+	if (fade < 1.0)
+	{
+		ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+		float noise = (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+		if (fade >= 0.0 ? noise >= fade : noise < 1.0 + fade)
+		{
+			discard;
+		}
+	}
+}
\ No newline at end of file
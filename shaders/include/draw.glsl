@@ -0,0 +1,15 @@
+// Per draw data of System::Program::Draw
+
+// Model matrix of every draw of the frame
+layout (std430, binding = 0) readonly buffer Models
+{
+	mat4 models[];
+};
+// Dithered coverage of every draw, see System::DrawRange::fade
+layout (std430, binding = 1) readonly buffer Fades
+{
+	float fades[];
+};
+
+// First draw of the current multi-draw, gl_DrawID restarts at 0 in each
+layout (location = 0) uniform int drawOffset;
\ No newline at end of file
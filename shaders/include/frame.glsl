@@ -0,0 +1,8 @@
+// Shared by every program, matches System::FrameUniforms
+layout (std140, binding = 0) uniform Frame
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec3 cameraPosition;
+};
\ No newline at end of file
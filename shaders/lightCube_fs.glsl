@@ -1,6 +1,6 @@
 #version 460 core
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
 void main()
 {
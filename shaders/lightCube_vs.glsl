@@ -1,14 +1,17 @@
 #version 460 core
+#ifdef GL_SPIRV
+#extension GL_GOOGLE_include_directive : require
+#endif
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 inColor;
 layout (location = 2) in vec2 inTexture;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (location = 0) uniform mat4 model;
+
+#include "include/frame.glsl"
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	gl_Position = viewProjection * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -39,5 +39,23 @@ void FileString::ChangeFile(const char* path)
     }
 }
 
+//********************************
+//      Functions
+//********************************
+//----------------------------------------------------------------
+const std::uint64_t HashBytes(const void* data, const size_t size, const std::uint64_t seed /*= sHashSeed*/)
+{
+    static const std::uint64_t sPrime = 1099511628211ull;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= sPrime;
+    }
+    return hash;
+}
+
 } // namespace System
 } // namespace Vision
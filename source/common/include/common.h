@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -78,5 +79,35 @@ inline const size_t RawArrayByteSize(const T(&)[N])
     return N * sizeof(T);
 }
 
+static const std::uint64_t sHashSeed = 14695981039346656037ull; // FNV-1a 64-bit offset basis
+
+/**
+ * @brief Computes a 64-bit FNV-1a hash of a block of memory.
+ *
+ * Passing the result of a previous call as seed chains several blocks into one hash.
+ *
+ * @param[in] data Pointer to the first byte to hash.
+ * @param[in] size Number of bytes to hash.
+ * @param[in] seed Starting value of the hash.
+ * @return The resulting hash.
+ */
+const std::uint64_t HashBytes(const void* data, const size_t size, const std::uint64_t seed = sHashSeed);
+
+/**
+ * @brief Computes a 32-bit FNV-1a hash of a null-terminated string, also at compile time.
+ *
+ * @param[in] text The string to hash.
+ * @param[in] seed Starting value of the hash.
+ * @return The resulting hash.
+ */
+constexpr std::uint32_t HashString(const char* text, std::uint32_t seed = 2166136261u)
+{
+    for (; *text != '\0'; ++text)
+    {
+        seed = (seed ^ static_cast<std::uint8_t>(*text)) * 16777619u;
+    }
+    return seed;
+}
+
 } // namespace System
 } // namespace Vision
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Vision
+{
+namespace Core
+{
+
+/**
+ * @brief Singleton pool of worker threads for data parallel work.
+ *
+ * Workers are started on first use. The calling thread always takes part in the work it
+ * submits, so ParallelFor can be nested and never waits on a busy pool.
+ */
+class JobPool
+{
+public:
+    // Processes the range [begin, end)
+    using RangeJob = std::function<void(const size_t begin, const size_t end)>;
+
+private:
+    struct Batch
+    {
+        RangeJob job;
+        size_t count;
+        size_t grain;
+        size_t chunks;
+        std::atomic<size_t> next;
+        std::atomic<size_t> done;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        Batch(const RangeJob& job, const size_t count, const size_t grain);
+    };
+
+    std::vector<std::thread> mWorkers;
+    std::deque<std::shared_ptr<Batch>> mBatches;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::once_flag mStarted;
+    bool mStop;
+
+    JobPool();
+    ~JobPool();
+
+    // Built on first use, so static initializers of other files can submit work too
+    static JobPool& Get();
+
+    void Start();
+    void WorkerLoop();
+    static void RunChunks(Batch& batch);
+
+public:
+    /**
+     * @brief Runs job over [0, count) split in chunks of grain elements, and waits for all of them.
+     *
+     * @param[in] count Number of elements to process.
+     * @param[in] grain Number of elements per chunk; small enough to balance, big enough to amortize.
+     * @param[in] job Function called once per chunk, possibly from several threads at once.
+     */
+    static void ParallelFor(const size_t count, const size_t grain, const RangeJob& job);
+
+    /**
+     * @brief Number of threads that may run jobs concurrently, the caller included.
+     */
+    static const size_t GetThreadCount();
+};
+
+} //namespace Core
+} //namespace Vision
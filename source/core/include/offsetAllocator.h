@@ -0,0 +1,132 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace Core
+{
+
+/**
+ * @brief Two-level segregated fit (TLSF) allocator of ranges inside an external resource.
+ *
+ * Manages offsets only, the memory itself lives elsewhere (typically a GL buffer). Free ranges
+ * are kept in 256 size bins, spaced like an 8-bit float, found with two bit scans, so Allocate
+ * and Free run in constant time. Freed ranges merge with free neighbours right away.
+ */
+class OffsetAllocator
+{
+public:
+    static constexpr std::uint32_t sNoSpace = 0xFFFFFFFF;
+
+    struct Allocation
+    {
+        std::uint32_t offset = sNoSpace;
+        std::uint32_t node = sNoSpace;  // Internal handle, needed to free the range
+
+        inline const bool IsValid() const { return offset != sNoSpace; }
+    };
+
+    struct Report
+    {
+        std::uint32_t size = 0;         // Total managed space
+        std::uint32_t totalFree = 0;
+        std::uint32_t largestFree = 0;
+        std::uint32_t freeRegions = 0;
+
+        // 0 when all the free space is contiguous, close to 1 when it is scattered in small holes
+        inline const float GetFragmentation() const { return totalFree == 0 ? 0.0f : 1.0f - float(largestFree) / float(totalFree); }
+    };
+
+private:
+    static const std::uint32_t sTopBins = 32;
+    static const std::uint32_t sBinsPerLeaf = 8;
+    static const std::uint32_t sLeafBins = sTopBins * sBinsPerLeaf;
+
+    struct Node
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+        std::uint32_t binPrev = sNoSpace;       // Free list of the bin
+        std::uint32_t binNext = sNoSpace;
+        std::uint32_t neighborPrev = sNoSpace;  // Adjacent ranges, by address
+        std::uint32_t neighborNext = sNoSpace;
+        bool used = false;
+    };
+
+    std::uint32_t mSize;
+    std::uint32_t mFreeStorage;
+    std::uint32_t mFreeRegions;
+    std::uint32_t mUsedBinsTop;
+    std::uint8_t mUsedBins[sTopBins];
+    std::uint32_t mBinHeads[sLeafBins];
+    std::uint32_t mHead;    // Node at offset 0
+    std::uint32_t mTail;    // Node at the highest address
+
+    std::vector<Node> mNodes;
+    std::vector<std::uint32_t> mFreeNodes;
+
+    const std::uint32_t NewNode();
+    const std::uint32_t InsertIntoBin(const std::uint32_t size, const std::uint32_t offset);
+    void RemoveFromBin(const std::uint32_t nodeIndex);
+
+public:
+    /**
+     * @param[in] size Space to manage, may be 0 and grown later.
+     */
+    OffsetAllocator(const std::uint32_t size = 0);
+
+    /**
+     * @brief Finds a free range of the given size.
+     *
+     * @return The range, invalid if no free range is large enough.
+     */
+    const Allocation Allocate(const std::uint32_t size);
+
+    /**
+     * @brief Returns a range to the free space.
+     */
+    void Free(const Allocation& allocation);
+
+    /**
+     * @brief Extends the managed space, the new space starts right after the old one.
+     */
+    void Grow(const std::uint32_t newSize);
+
+    /**
+     * @brief Forgets every allocation, the whole space becomes one free range.
+     */
+    void Reset(const std::uint32_t size);
+
+    /**
+     * @brief The used range at the highest offset, invalid if nothing is allocated.
+     */
+    const Allocation GetLastUsed() const;
+
+    /**
+     * @brief The used range right after the free range at the lowest offset, invalid if no range has free space before it.
+     *
+     * Walks the ranges from the start, so the cost grows with their number.
+     */
+    const Allocation GetFirstAfterHole() const;
+
+    /**
+     * @brief Moves a used range down over the free range right before it, the free space ends up after it.
+     *
+     * The caller moves the contents: the old and new ranges overlap when the range is larger
+     * than the free space.
+     *
+     * @param[in,out] allocation The range to move, its offset is updated.
+     * @return Distance moved, 0 if the range has no free space before it.
+     */
+    const std::uint32_t Slide(Allocation& allocation);
+
+    const std::uint32_t GetAllocationSize(const Allocation& allocation) const;
+    const Report GetReport() const;
+    inline const std::uint32_t GetSize() const { return mSize; }
+};
+
+} // namespace Core
+} // namespace Vision
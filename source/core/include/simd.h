@@ -0,0 +1,45 @@
+#pragma once
+
+// Instruction sets the SIMD kernels are compiled for. SSE2 is the x64 baseline, used
+// unconditionally. Kernels for the later sets are compiled into every x86 build with
+// VISION_SIMD_TARGET and only run when Simd::Has* reports the CPU supports them; every
+// kernel keeps a scalar path for builds without any.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VISION_SIMD_SSE2 1
+#endif
+
+#if defined(VISION_SIMD_SSE2) && (defined(_MSC_VER) || defined(__GNUC__))
+#define VISION_SIMD_SSSE3 1
+#define VISION_SIMD_AVX 1
+#define VISION_SIMD_AVX2 1
+#endif
+
+#if defined(VISION_SIMD_AVX) || defined(VISION_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(VISION_SIMD_SSSE3)
+#include <tmmintrin.h>
+#elif defined(VISION_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+// Lets a function use an instruction set above the baseline, e.g. VISION_SIMD_TARGET("avx2").
+// MSVC takes any intrinsic anywhere; GCC and Clang need the set named on the function.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VISION_SIMD_TARGET(set)
+#else
+#define VISION_SIMD_TARGET(set) __attribute__((target(set)))
+#endif
+
+namespace Vision
+{
+namespace Simd
+{
+
+// Whether the CPU runs the set, and the OS saves the AVX registers. Detected once with CPUID
+const bool HasSSSE3();
+const bool HasAVX();
+const bool HasAVX2();
+
+} // namespace Simd
+} // namespace Vision
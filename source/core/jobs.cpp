@@ -0,0 +1,155 @@
+#include "include/jobs.h"
+
+#include <algorithm>
+
+namespace Vision
+{
+namespace Core
+{
+
+//********************************
+//     Struct JobPool::Batch
+//********************************
+//----------------------------------------------------------------
+JobPool::Batch::Batch(const RangeJob& job, const size_t count, const size_t grain)
+    : job(job)
+    , count(count)
+    , grain(grain)
+    , chunks((count + grain - 1) / grain)
+    , next(0)
+    , done(0)
+    , mutex()
+    , finished()
+{}
+
+//********************************
+//     (Singleton) Class JobPool
+//********************************
+//----------------------------------------------------------------
+JobPool::JobPool()
+    : mWorkers()
+    , mBatches()
+    , mMutex()
+    , mWakeUp()
+    , mStarted()
+    , mStop(false)
+{}
+
+//----------------------------------------------------------------
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+
+    for (std::thread& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+//----------------------------------------------------------------
+JobPool& JobPool::Get()
+{
+    static JobPool pool;
+    return pool;
+}
+
+//----------------------------------------------------------------
+void JobPool::Start()
+{
+    // One thread is left for the caller, which works on its own batches
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 1; i < hardware; ++i)
+    {
+        mWorkers.emplace_back(&JobPool::WorkerLoop, this);
+    }
+}
+
+//----------------------------------------------------------------
+void JobPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeUp.wait(lock, [this]() { return mStop || !mBatches.empty(); });
+            if (mStop)
+            {
+                return;
+            }
+
+            batch = mBatches.front();
+            if (batch->next >= batch->chunks)
+            {
+                // Every chunk is taken, the remaining ones are finishing elsewhere
+                mBatches.pop_front();
+                continue;
+            }
+        }
+
+        RunChunks(*batch);
+    }
+}
+
+//----------------------------------------------------------------
+void JobPool::RunChunks(Batch& batch)
+{
+    size_t chunk;
+    while ((chunk = batch.next++) < batch.chunks)
+    {
+        const size_t begin = chunk * batch.grain;
+        batch.job(begin, std::min(batch.count, begin + batch.grain));
+
+        if (++batch.done == batch.chunks)
+        {
+            std::lock_guard<std::mutex> lock(batch.mutex);
+            batch.finished.notify_all();
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void JobPool::ParallelFor(const size_t count, const size_t grain, const RangeJob& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    JobPool& pool = Get();
+    std::call_once(pool.mStarted, &JobPool::Start, &pool);
+
+    const size_t chunkSize = std::max<size_t>(1, grain);
+    if (count <= chunkSize || pool.mWorkers.empty())
+    {
+        job(0, count);
+        return;
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(job, count, chunkSize);
+    {
+        std::lock_guard<std::mutex> lock(pool.mMutex);
+        pool.mBatches.push_back(batch);
+    }
+    pool.mWakeUp.notify_all();
+
+    RunChunks(*batch);
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->finished.wait(lock, [&batch]() { return batch->done == batch->chunks; });
+}
+
+//----------------------------------------------------------------
+const size_t JobPool::GetThreadCount()
+{
+    JobPool& pool = Get();
+    std::call_once(pool.mStarted, &JobPool::Start, &pool);
+    return pool.mWorkers.size() + 1;
+}
+
+} // namespace Core
+} // namespace Vision
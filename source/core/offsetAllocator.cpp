@@ -0,0 +1,468 @@
+#include "include/offsetAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Vision
+{
+namespace Core
+{
+
+namespace
+{
+    static const std::uint32_t sMantissaBits = 3;
+    static const std::uint32_t sMantissaValue = 1 << sMantissaBits;
+    static const std::uint32_t sMantissaMask = sMantissaValue - 1;
+
+    //----------------------------------------------------------------
+    inline const std::uint32_t HighestSetBit(const std::uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return index;
+#else
+        return 31 - __builtin_clz(value);
+#endif
+    }
+
+    //----------------------------------------------------------------
+    inline const std::uint32_t LowestSetBit(const std::uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return index;
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+
+    //----------------------------------------------------------------
+    // Lowest set bit at or above startIndex, sNoSpace if there is none
+    inline const std::uint32_t LowestSetBitAfter(const std::uint32_t value, const std::uint32_t startIndex)
+    {
+        if (startIndex >= 32)
+        {
+            return OffsetAllocator::sNoSpace;
+        }
+        const std::uint32_t masked = value & ~((1u << startIndex) - 1);
+        return masked == 0 ? OffsetAllocator::sNoSpace : LowestSetBit(masked);
+    }
+
+    //----------------------------------------------------------------
+    // Bin of the sizes as an 8-bit float: 5 bits of exponent, 3 of mantissa. Rounding up gives
+    // a bin whose every range fits the size; rounding down the bin a free range is filed in.
+    const std::uint32_t SizeToBin(const std::uint32_t size, const bool roundUp)
+    {
+        if (size < sMantissaValue)
+        {
+            return size;
+        }
+
+        const std::uint32_t mantissaStart = HighestSetBit(size) - sMantissaBits;
+        const std::uint32_t exponent = mantissaStart + 1;
+        std::uint32_t mantissa = (size >> mantissaStart) & sMantissaMask;
+
+        if (roundUp && (size & ((1u << mantissaStart) - 1)) != 0)
+        {
+            ++mantissa; // May carry into the exponent
+        }
+        return (exponent << sMantissaBits) + mantissa;
+    }
+} // namespace
+
+//********************************
+//     Class OffsetAllocator
+//********************************
+//----------------------------------------------------------------
+OffsetAllocator::OffsetAllocator(const std::uint32_t size /*= 0*/)
+    : mSize(0)
+    , mFreeStorage(0)
+    , mFreeRegions(0)
+    , mUsedBinsTop(0)
+    , mHead(sNoSpace)
+    , mTail(sNoSpace)
+    , mNodes()
+    , mFreeNodes()
+{
+    Reset(size);
+}
+
+//----------------------------------------------------------------
+void OffsetAllocator::Reset(const std::uint32_t size)
+{
+    mSize = 0;
+    mFreeStorage = 0;
+    mFreeRegions = 0;
+    mUsedBinsTop = 0;
+    mHead = sNoSpace;
+    mTail = sNoSpace;
+    std::memset(mUsedBins, 0, sizeof(mUsedBins));
+    std::fill(std::begin(mBinHeads), std::end(mBinHeads), sNoSpace);
+    mNodes.clear();
+    mFreeNodes.clear();
+
+    Grow(size);
+}
+
+//----------------------------------------------------------------
+const std::uint32_t OffsetAllocator::NewNode()
+{
+    if (mFreeNodes.empty())
+    {
+        mNodes.emplace_back();
+        return static_cast<std::uint32_t>(mNodes.size() - 1);
+    }
+
+    const std::uint32_t nodeIndex = mFreeNodes.back();
+    mFreeNodes.pop_back();
+    mNodes[nodeIndex] = Node();
+    return nodeIndex;
+}
+
+//----------------------------------------------------------------
+const std::uint32_t OffsetAllocator::InsertIntoBin(const std::uint32_t size, const std::uint32_t offset)
+{
+    const std::uint32_t binIndex = SizeToBin(size, false);
+    const std::uint32_t topBin = binIndex >> sMantissaBits;
+    const std::uint32_t leafBin = binIndex & sMantissaMask;
+
+    mUsedBinsTop |= 1u << topBin;
+    mUsedBins[topBin] |= 1u << leafBin;
+
+    const std::uint32_t head = mBinHeads[binIndex];
+    const std::uint32_t nodeIndex = NewNode();
+    Node& node = mNodes[nodeIndex];
+    node.offset = offset;
+    node.size = size;
+    node.binNext = head;
+    if (head != sNoSpace)
+    {
+        mNodes[head].binPrev = nodeIndex;
+    }
+    mBinHeads[binIndex] = nodeIndex;
+
+    mFreeStorage += size;
+    ++mFreeRegions;
+    return nodeIndex;
+}
+
+//----------------------------------------------------------------
+void OffsetAllocator::RemoveFromBin(const std::uint32_t nodeIndex)
+{
+    Node& node = mNodes[nodeIndex];
+
+    if (node.binPrev != sNoSpace)
+    {
+        mNodes[node.binPrev].binNext = node.binNext;
+        if (node.binNext != sNoSpace)
+        {
+            mNodes[node.binNext].binPrev = node.binPrev;
+        }
+    }
+    else
+    {
+        // Head of its bin
+        const std::uint32_t binIndex = SizeToBin(node.size, false);
+        const std::uint32_t topBin = binIndex >> sMantissaBits;
+        const std::uint32_t leafBin = binIndex & sMantissaMask;
+
+        mBinHeads[binIndex] = node.binNext;
+        if (node.binNext != sNoSpace)
+        {
+            mNodes[node.binNext].binPrev = sNoSpace;
+        }
+        else
+        {
+            mUsedBins[topBin] &= ~(1u << leafBin);
+            if (mUsedBins[topBin] == 0)
+            {
+                mUsedBinsTop &= ~(1u << topBin);
+            }
+        }
+    }
+
+    mFreeStorage -= node.size;
+    --mFreeRegions;
+    mFreeNodes.push_back(nodeIndex);
+}
+
+//----------------------------------------------------------------
+const OffsetAllocator::Allocation OffsetAllocator::Allocate(const std::uint32_t size)
+{
+    Allocation allocation;
+    if (size == 0 || size > mFreeStorage)
+    {
+        return allocation;
+    }
+
+    // Smallest bin whose ranges are all large enough
+    const std::uint32_t minBin = SizeToBin(size, true);
+    const std::uint32_t minTop = minBin >> sMantissaBits;
+    const std::uint32_t minLeaf = minBin & sMantissaMask;
+
+    std::uint32_t topBin = minTop;
+    std::uint32_t leafBin = sNoSpace;
+    if (minTop < sTopBins && (mUsedBinsTop & (1u << minTop)) != 0)
+    {
+        leafBin = LowestSetBitAfter(mUsedBins[minTop], minLeaf);
+    }
+    if (leafBin == sNoSpace)
+    {
+        topBin = LowestSetBitAfter(mUsedBinsTop, minTop + 1);
+        if (topBin == sNoSpace)
+        {
+            return allocation;
+        }
+        leafBin = LowestSetBit(mUsedBins[topBin]);
+    }
+
+    const std::uint32_t nodeIndex = mBinHeads[(topBin << sMantissaBits) | leafBin];
+    const std::uint32_t nodeSize = mNodes[nodeIndex].size;
+    RemoveFromBin(nodeIndex);
+
+    // RemoveFromBin released the node, take it back as the used range
+    mFreeNodes.pop_back();
+    Node& node = mNodes[nodeIndex];
+    node.used = true;
+    node.size = size;
+    node.binPrev = sNoSpace;
+    node.binNext = sNoSpace;
+
+    // The rest of the range stays free, right after the allocation
+    if (nodeSize > size)
+    {
+        const std::uint32_t rest = InsertIntoBin(nodeSize - size, mNodes[nodeIndex].offset + size);
+        Node& used = mNodes[nodeIndex];
+        if (used.neighborNext != sNoSpace)
+        {
+            mNodes[used.neighborNext].neighborPrev = rest;
+        }
+        mNodes[rest].neighborPrev = nodeIndex;
+        mNodes[rest].neighborNext = used.neighborNext;
+        used.neighborNext = rest;
+        if (mTail == nodeIndex)
+        {
+            mTail = rest;
+        }
+    }
+
+    allocation.offset = mNodes[nodeIndex].offset;
+    allocation.node = nodeIndex;
+    return allocation;
+}
+
+//----------------------------------------------------------------
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return;
+    }
+
+    Node node = mNodes[allocation.node];
+    std::uint32_t offset = node.offset;
+    std::uint32_t size = node.size;
+
+    if (node.neighborPrev != sNoSpace && !mNodes[node.neighborPrev].used)
+    {
+        const Node& prev = mNodes[node.neighborPrev];
+        offset = prev.offset;
+        size += prev.size;
+        const std::uint32_t prevIndex = node.neighborPrev;
+        node.neighborPrev = prev.neighborPrev;
+        RemoveFromBin(prevIndex);
+    }
+
+    if (node.neighborNext != sNoSpace && !mNodes[node.neighborNext].used)
+    {
+        const Node& next = mNodes[node.neighborNext];
+        size += next.size;
+        const std::uint32_t nextIndex = node.neighborNext;
+        node.neighborNext = next.neighborNext;
+        RemoveFromBin(nextIndex);
+    }
+
+    mFreeNodes.push_back(allocation.node);
+
+    const std::uint32_t merged = InsertIntoBin(size, offset);
+    mNodes[merged].neighborPrev = node.neighborPrev;
+    mNodes[merged].neighborNext = node.neighborNext;
+    if (node.neighborPrev != sNoSpace)
+    {
+        mNodes[node.neighborPrev].neighborNext = merged;
+    }
+    else
+    {
+        mHead = merged;
+    }
+    if (node.neighborNext != sNoSpace)
+    {
+        mNodes[node.neighborNext].neighborPrev = merged;
+    }
+    else
+    {
+        mTail = merged;
+    }
+}
+
+//----------------------------------------------------------------
+void OffsetAllocator::Grow(const std::uint32_t newSize)
+{
+    if (newSize <= mSize)
+    {
+        return;
+    }
+
+    // Append the new space as a used range and free it, so it merges with a free tail
+    const std::uint32_t nodeIndex = NewNode();
+    Node& node = mNodes[nodeIndex];
+    node.offset = mSize;
+    node.size = newSize - mSize;
+    node.used = true;
+    node.neighborPrev = mTail;
+    if (mTail != sNoSpace)
+    {
+        mNodes[mTail].neighborNext = nodeIndex;
+    }
+    else
+    {
+        mHead = nodeIndex;
+    }
+    mTail = nodeIndex;
+    mSize = newSize;
+
+    Allocation allocation;
+    allocation.offset = mNodes[nodeIndex].offset;
+    allocation.node = nodeIndex;
+    Free(allocation);
+}
+
+//----------------------------------------------------------------
+const OffsetAllocator::Allocation OffsetAllocator::GetLastUsed() const
+{
+    Allocation allocation;
+    std::uint32_t nodeIndex = mTail;
+    if (nodeIndex != sNoSpace && !mNodes[nodeIndex].used)
+    {
+        // Free neighbours are always merged, so the one before a free tail is used
+        nodeIndex = mNodes[nodeIndex].neighborPrev;
+    }
+    if (nodeIndex != sNoSpace)
+    {
+        allocation.offset = mNodes[nodeIndex].offset;
+        allocation.node = nodeIndex;
+    }
+    return allocation;
+}
+
+//----------------------------------------------------------------
+const OffsetAllocator::Allocation OffsetAllocator::GetFirstAfterHole() const
+{
+    Allocation allocation;
+    for (std::uint32_t nodeIndex = mHead; nodeIndex != sNoSpace; nodeIndex = mNodes[nodeIndex].neighborNext)
+    {
+        const Node& node = mNodes[nodeIndex];
+        if (node.used && node.neighborPrev != sNoSpace && !mNodes[node.neighborPrev].used)
+        {
+            allocation.offset = node.offset;
+            allocation.node = nodeIndex;
+            break;
+        }
+    }
+    return allocation;
+}
+
+//----------------------------------------------------------------
+const std::uint32_t OffsetAllocator::Slide(Allocation& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return 0;
+    }
+
+    const std::uint32_t nodeIndex = allocation.node;
+    const std::uint32_t holeIndex = mNodes[nodeIndex].neighborPrev;
+    if (holeIndex == sNoSpace || mNodes[holeIndex].used)
+    {
+        return 0;
+    }
+
+    // Take the hole out of the chain, the range moves to its start
+    const std::uint32_t distance = mNodes[holeIndex].size;
+    const std::uint32_t before = mNodes[holeIndex].neighborPrev;
+    RemoveFromBin(holeIndex);
+
+    mNodes[nodeIndex].offset -= distance;
+    mNodes[nodeIndex].neighborPrev = before;
+    if (before != sNoSpace)
+    {
+        mNodes[before].neighborNext = nodeIndex;
+    }
+    else
+    {
+        mHead = nodeIndex;
+    }
+
+    // The same space opens after the range, merged with the next free range if any
+    std::uint32_t offset = mNodes[nodeIndex].offset + mNodes[nodeIndex].size;
+    std::uint32_t size = distance;
+    std::uint32_t after = mNodes[nodeIndex].neighborNext;
+    if (after != sNoSpace && !mNodes[after].used)
+    {
+        size += mNodes[after].size;
+        const std::uint32_t freeIndex = after;
+        after = mNodes[after].neighborNext;
+        RemoveFromBin(freeIndex);
+    }
+
+    const std::uint32_t hole = InsertIntoBin(size, offset);
+    mNodes[hole].neighborPrev = nodeIndex;
+    mNodes[hole].neighborNext = after;
+    mNodes[nodeIndex].neighborNext = hole;
+    if (after != sNoSpace)
+    {
+        mNodes[after].neighborPrev = hole;
+    }
+    else
+    {
+        mTail = hole;
+    }
+
+    allocation.offset = mNodes[nodeIndex].offset;
+    return distance;
+}
+
+//----------------------------------------------------------------
+const std::uint32_t OffsetAllocator::GetAllocationSize(const Allocation& allocation) const
+{
+    return allocation.IsValid() ? mNodes[allocation.node].size : 0;
+}
+
+//----------------------------------------------------------------
+const OffsetAllocator::Report OffsetAllocator::GetReport() const
+{
+    Report report;
+    report.size = mSize;
+    report.totalFree = mFreeStorage;
+    report.freeRegions = mFreeRegions;
+
+    if (mUsedBinsTop != 0)
+    {
+        // Ranges of the highest used bin are the largest ones, within the bin's spacing
+        const std::uint32_t topBin = HighestSetBit(mUsedBinsTop);
+        const std::uint32_t leafBin = HighestSetBit(mUsedBins[topBin]);
+        for (std::uint32_t node = mBinHeads[(topBin << sMantissaBits) | leafBin]; node != sNoSpace; node = mNodes[node].binNext)
+        {
+            report.largestFree = std::max(report.largestFree, mNodes[node].size);
+        }
+    }
+    return report;
+}
+
+} // namespace Core
+} // namespace Vision
@@ -0,0 +1,80 @@
+#include "include/simd.h"
+
+#if defined(VISION_SIMD_SSE2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Vision
+{
+namespace Simd
+{
+
+namespace
+{
+    struct Features
+    {
+        bool ssse3 = false;
+        bool avx = false;
+        bool avx2 = false;
+    };
+
+    //----------------------------------------------------------------
+    const Features Detect()
+    {
+        Features features;
+
+#if defined(VISION_SIMD_SSE2) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int leafCount = info[0];
+
+        __cpuid(info, 1);
+        features.ssse3 = (info[2] & (1 << 9)) != 0;
+        // AVX needs the OS to save the YMM registers on context switches: OSXSAVE, then XCR0
+        const bool osSavesYMM = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        features.avx = osSavesYMM && (info[2] & (1 << 28)) != 0;
+
+        if (leafCount >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            features.avx2 = features.avx && (info[1] & (1 << 5)) != 0;
+        }
+#elif defined(VISION_SIMD_SSE2)
+        // Checks the OS support of AVX too
+        __builtin_cpu_init();
+        features.ssse3 = __builtin_cpu_supports("ssse3");
+        features.avx = __builtin_cpu_supports("avx");
+        features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+        return features;
+    }
+
+    //----------------------------------------------------------------
+    const Features& GetFeatures()
+    {
+        static const Features sFeatures = Detect();
+        return sFeatures;
+    }
+} // namespace
+
+//----------------------------------------------------------------
+const bool HasSSSE3()
+{
+    return GetFeatures().ssse3;
+}
+
+//----------------------------------------------------------------
+const bool HasAVX()
+{
+    return GetFeatures().avx;
+}
+
+//----------------------------------------------------------------
+const bool HasAVX2()
+{
+    return GetFeatures().avx2;
+}
+
+} // namespace Simd
+} // namespace Vision
@@ -0,0 +1,386 @@
+#include <graphic/include/atlas.h>
+
+#include <graphic/include/blockCompression.h>
+#include <graphic/include/mipmap.h>
+#include <graphic/include/pixelFormat.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+namespace
+{
+    //----------------------------------------------------------------
+    const int AlignToBlock(const int size)
+    {
+        return (size + 3) & ~3;
+    }
+
+    //----------------------------------------------------------------
+    const int NextPowerOfTwo(const int size)
+    {
+        int power = 1;
+        while (power < size)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+} // namespace
+
+//********************************
+//     Class AtlasBuilder
+//********************************
+//----------------------------------------------------------------
+AtlasBuilder::AtlasBuilder(const int pageSize /*= 2048*/, const int padding /*= 8*/)
+    : mPageSize(pageSize)
+    , mPadding(padding)
+    , mEntries()
+    , mPageNames()
+{}
+
+//----------------------------------------------------------------
+void AtlasBuilder::Add(const char* textureName)
+{
+    const TextureInfo* texture = TextureLoader::FindTexture(textureName);
+    if (texture == nullptr || !texture->CheckInfo())
+    {
+        LOG_STDERR("Texture '" << textureName << "' can't be added to an atlas.");
+        return;
+    }
+
+    Entry entry;
+    entry.texture = textureName;
+    entry.width = texture->width;
+    entry.height = texture->height;
+    entry.slotWidth = AlignToBlock(texture->width + mPadding * 2);
+    entry.slotHeight = AlignToBlock(texture->height + mPadding * 2);
+    mEntries.push_back(entry);
+}
+
+//----------------------------------------------------------------
+const bool AtlasBuilder::Fit(const Page& page, const size_t node, const int width, const int height, int& y) const
+{
+    const int x = page.skyline[node].x;
+    if (x + width > mPageSize)
+    {
+        return false;
+    }
+
+    // Rest on the highest skyline segment under the rectangle
+    y = 0;
+    int remaining = width;
+    for (size_t i = node; remaining > 0; ++i)
+    {
+        y = std::max(y, page.skyline[i].y);
+        if (y + height > mPageSize)
+        {
+            return false;
+        }
+        remaining -= page.skyline[i].width;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+const bool AtlasBuilder::Insert(Page& page, const int width, const int height, int& x, int& y) const
+{
+    size_t best = page.skyline.size();
+    int bestY = mPageSize;
+    int bestX = mPageSize;
+
+    for (size_t node = 0; node < page.skyline.size(); ++node)
+    {
+        int fitY;
+        if (Fit(page, node, width, height, fitY) && (fitY < bestY || (fitY == bestY && page.skyline[node].x < bestX)))
+        {
+            best = node;
+            bestY = fitY;
+            bestX = page.skyline[node].x;
+        }
+    }
+
+    if (best == page.skyline.size())
+    {
+        return false;
+    }
+
+    x = bestX;
+    y = bestY;
+
+    // Raise the skyline over the rectangle, trimming the segments it covers
+    std::vector<SkylineNode>& skyline = page.skyline;
+    skyline.insert(skyline.begin() + best, SkylineNode{ x, y + height, width });
+    for (size_t i = best + 1; i < skyline.size();)
+    {
+        const int coveredEnd = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= coveredEnd)
+        {
+            break;
+        }
+
+        const int shrink = coveredEnd - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width <= 0)
+        {
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // Merge neighbours of the same height
+    for (size_t i = 1; i < skyline.size();)
+    {
+        if (skyline[i - 1].y == skyline[i].y)
+        {
+            skyline[i - 1].width += skyline[i].width;
+            skyline.erase(skyline.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    page.usedHeight = std::max(page.usedHeight, y + height);
+    return true;
+}
+
+//----------------------------------------------------------------
+void AtlasBuilder::Blit(const Entry& entry, const TextureInfo& source, std::vector<unsigned char>& pixels, const int pageWidth) const
+{
+    // Base level in RGBA, converted if the texture wasn't cooked or was compressed
+    std::vector<unsigned char> converted;
+    const unsigned char* rgba;
+    if (source.IsCooked() && source.format == System::Types::eTextureFormat::RGBA8)
+    {
+        rgba = source.levels.front().data.data();
+    }
+    else if (source.IsCooked())
+    {
+        converted.resize(static_cast<size_t>(source.width) * source.height * 4);
+        BlockCompression::Decode(source.levels.front().data.data(), source.width, source.height, source.format, converted.data());
+        rgba = converted.data();
+    }
+    else
+    {
+        converted.resize(static_cast<size_t>(source.width) * source.height * 4);
+        Pixel::ConvertToRGBA(source.data, source.nrChannels, converted.data(), static_cast<size_t>(source.width) * source.height);
+        rgba = converted.data();
+    }
+
+    // The whole slot is filled, gutter texels repeat the closest edge texel
+    for (int y = 0; y < entry.slotHeight; ++y)
+    {
+        const int srcY = std::min(std::max(y - mPadding, 0), entry.height - 1);
+        unsigned char* dstRow = &pixels[(static_cast<size_t>(entry.y + y) * pageWidth + entry.x) * 4];
+        const unsigned char* srcRow = &rgba[static_cast<size_t>(srcY) * entry.width * 4];
+
+        for (int x = 0; x < mPadding; ++x)
+        {
+            std::memcpy(&dstRow[x * 4], srcRow, 4);
+        }
+        std::memcpy(&dstRow[mPadding * 4], srcRow, static_cast<size_t>(entry.width) * 4);
+        for (int x = mPadding + entry.width; x < entry.slotWidth; ++x)
+        {
+            std::memcpy(&dstRow[x * 4], &srcRow[(entry.width - 1) * 4], 4);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const size_t AtlasBuilder::Build(const char* pageName /*= "atlas"*/)
+{
+    // Tallest first keeps the skyline flat
+    std::sort(mEntries.begin(), mEntries.end(), [](const Entry& a, const Entry& b)
+    {
+        return a.slotHeight != b.slotHeight ? a.slotHeight > b.slotHeight : a.slotWidth > b.slotWidth;
+    });
+
+    std::vector<Page> pages;
+    for (Entry& entry : mEntries)
+    {
+        if (entry.slotWidth > mPageSize || entry.slotHeight > mPageSize)
+        {
+            LOG_STDERR("Texture '" << entry.texture << "' is larger than an atlas page.");
+            continue;
+        }
+
+        for (size_t i = 0; i < pages.size() && entry.page < 0; ++i)
+        {
+            if (Insert(pages[i], entry.slotWidth, entry.slotHeight, entry.x, entry.y))
+            {
+                entry.page = static_cast<int>(i);
+            }
+        }
+        if (entry.page < 0)
+        {
+            pages.emplace_back();
+            pages.back().skyline.push_back(SkylineNode{ 0, 0, mPageSize });
+            Insert(pages.back(), entry.slotWidth, entry.slotHeight, entry.x, entry.y);
+            entry.page = static_cast<int>(pages.size() - 1);
+        }
+    }
+
+    mPageNames.clear();
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        // Pages only take the height they use
+        const int width = mPageSize;
+        const int height = NextPowerOfTwo(pages[i].usedHeight);
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4, 0);
+
+        for (const Entry& entry : mEntries)
+        {
+            if (entry.page == static_cast<int>(i))
+            {
+                Blit(entry, *TextureLoader::FindTexture(entry.texture.c_str()), pixels, width);
+            }
+        }
+
+        Mipmap::Settings settings;
+        settings.wrap = false;
+
+        std::unique_ptr<TextureInfo> page(new TextureInfo());
+        page->width = width;
+        page->height = height;
+        page->nrChannels = 4;
+        page->levels = Mipmap::GenerateChain(pixels.data(), width, height, settings);
+
+        const std::string name = std::string(pageName) + std::to_string(i);
+        TextureInfo& added = TextureLoader::AddTexture(std::move(page), name.c_str());
+        mPageNames.push_back(added.name);
+
+        for (const Entry& entry : mEntries)
+        {
+            if (entry.page == static_cast<int>(i))
+            {
+                AtlasRegion region;
+                region.page = added.name;
+                region.uvOffset = System::Types::Vector2(float(entry.x + mPadding) / width, float(entry.y + mPadding) / height);
+                region.uvScale = System::Types::Vector2(float(entry.width) / width, float(entry.height) / height);
+                TextureLoader::SetAtlasRegion(entry.texture.c_str(), region);
+            }
+        }
+    }
+
+    return pages.size();
+}
+
+//----------------------------------------------------------------
+const bool AtlasBuilder::Save(const char* manifestPath) const
+{
+    std::ofstream manifest(manifestPath);
+    if (!manifest)
+    {
+        LOG_STDERR("Failed writing atlas manifest \'" << manifestPath << "\'.");
+        return false;
+    }
+
+    const std::filesystem::path directory = std::filesystem::path(manifestPath).parent_path();
+    bool saved = true;
+
+    manifest << std::setprecision(9);
+
+    for (const std::string& name : mPageNames)
+    {
+        const std::string file = name + TextureCook::sCookedExtension;
+        saved &= TextureCook::Save(*TextureLoader::FindTexture(name.c_str()), (directory / file).string().c_str());
+        manifest << "page\n" << name << "\n" << file << "\n";
+    }
+
+    for (const Entry& entry : mEntries)
+    {
+        const AtlasRegion* region = TextureLoader::FindAtlasRegion(entry.texture.c_str());
+        if (region != nullptr)
+        {
+            manifest << "region " << region->uvOffset.x << " " << region->uvOffset.y << " "
+                     << region->uvScale.x << " " << region->uvScale.y << "\n"
+                     << entry.texture << "\n" << region->page << "\n";
+        }
+    }
+
+    return saved && manifest.good();
+}
+
+//----------------------------------------------------------------
+const bool AtlasBuilder::Load(const char* manifestPath)
+{
+    std::ifstream manifest(manifestPath);
+    if (!manifest)
+    {
+        LOG_STDERR("Failed reading atlas manifest \'" << manifestPath << "\'.");
+        return false;
+    }
+
+    const std::filesystem::path directory = std::filesystem::path(manifestPath).parent_path();
+    std::map<std::string, std::string> pageNames;   // Name in the manifest -> name in the loader
+    bool loaded = true;
+
+    // Names may hold spaces, so each one is on its own line after the line of its entry
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::istringstream entry(line);
+        std::string kind;
+        entry >> kind;
+
+        if (kind.empty())
+        {
+            continue;
+        }
+        else if (kind == "page")
+        {
+            std::string name, file;
+            std::getline(manifest, name);
+            std::getline(manifest, file);
+            if (!manifest)
+            {
+                LOG_STDERR("Truncated entry in atlas manifest \'" << manifestPath << "\'.");
+                return false;
+            }
+
+            TextureInfo& page = TextureLoader::AddTexture((directory / file).string().c_str(), name.c_str());
+            loaded &= page.CheckInfo();
+            pageNames[name] = page.name;
+        }
+        else if (kind == "region")
+        {
+            std::string texture, page;
+            AtlasRegion region;
+            entry >> region.uvOffset.x >> region.uvOffset.y >> region.uvScale.x >> region.uvScale.y;
+            std::getline(manifest, texture);
+            std::getline(manifest, page);
+            if (!manifest || entry.fail())
+            {
+                LOG_STDERR("Truncated entry in atlas manifest \'" << manifestPath << "\'.");
+                return false;
+            }
+
+            auto pageName = pageNames.find(page);
+            region.page = pageName != pageNames.end() ? pageName->second : page;
+            TextureLoader::SetAtlasRegion(texture.c_str(), region);
+        }
+        else
+        {
+            LOG_STDERR("Unknown entry '" << kind << "' in atlas manifest \'" << manifestPath << "\'.");
+            return false;
+        }
+    }
+
+    return loaded;
+}
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,856 @@
+#include <graphic/include/blockCompression.h>
+
+#include <core/include/jobs.h>
+#include <core/include/simd.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace BlockCompression
+{
+
+using System::Types::eTextureFormat;
+
+namespace
+{
+    static const size_t sBlockRowsPerJob = 4;
+    static const int sRefineIterations = 2;
+    static const int sPowerIterations = 8;
+
+    // Interpolation weights of 4-bit BC7 indices, out of 64
+    static const int sBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    static const float sBC7Fractions[16] =
+    {
+        0 / 64.0f, 4 / 64.0f, 9 / 64.0f, 13 / 64.0f, 17 / 64.0f, 21 / 64.0f, 26 / 64.0f, 30 / 64.0f,
+        34 / 64.0f, 38 / 64.0f, 43 / 64.0f, 47 / 64.0f, 51 / 64.0f, 55 / 64.0f, 60 / 64.0f, 64 / 64.0f
+    };
+
+    // Fraction of the second endpoint for each BC1 color index
+    static const float sBC1Fractions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    /**
+     * @brief Color endpoints, indices and squared error of one fitted block.
+     */
+    struct BlockFit
+    {
+        unsigned char palette[16 * 4];
+        unsigned char indices[16];
+        int error = INT_MAX;
+    };
+
+    //----------------------------------------------------------------
+    inline const int Clamp(const int value, const int low, const int high)
+    {
+        return std::min(std::max(value, low), high);
+    }
+
+    //----------------------------------------------------------------
+    void FetchBlock(const unsigned char* rgba, const int width, const int height, const int blockX, const int blockY, unsigned char* texels)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            const int srcY = std::min(blockY * 4 + y, height - 1);
+            for (int x = 0; x < 4; ++x)
+            {
+                const int srcX = std::min(blockX * 4 + x, width - 1);
+                std::memcpy(&texels[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(srcY) * width + srcX) * 4], 4);
+            }
+        }
+    }
+
+    //----------------------------------------------------------------
+    void StoreBlock(const unsigned char* texels, const int width, const int height, const int blockX, const int blockY, unsigned char* rgba)
+    {
+        for (int y = 0; y < 4 && blockY * 4 + y < height; ++y)
+        {
+            for (int x = 0; x < 4 && blockX * 4 + x < width; ++x)
+            {
+                const size_t dst = (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4;
+                std::memcpy(&rgba[dst], &texels[(y * 4 + x) * 4], 4);
+            }
+        }
+    }
+
+    //----------------------------------------------------------------
+    // Picks the closest palette entry for every texel of a block, returns the summed squared error
+    const int FitIndices(const unsigned char* texels, const unsigned char* palette, const int count, const bool useAlpha, unsigned char* indices)
+    {
+        int total = 0;
+#if defined(VISION_SIMD_SSE2)
+        // Two texels per register as 16-bit RGBA, each lane pair keeps its own best entry
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = useAlpha ? _mm_set1_epi32(-1) : _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+        __m128i entries[16];
+        for (int j = 0; j < count; ++j)
+        {
+            int packed;
+            std::memcpy(&packed, &palette[j * 4], 4);
+            const __m128i entry = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+            entries[j] = _mm_unpacklo_epi64(entry, entry);
+        }
+
+        for (int i = 0; i < 16; i += 2)
+        {
+            const __m128i texel = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&texels[i * 4])), zero);
+            __m128i bestError = _mm_set1_epi32(INT_MAX);
+            __m128i bestIndex = zero;
+
+            for (int j = 0; j < count; ++j)
+            {
+                const __m128i diff = _mm_and_si128(_mm_sub_epi16(texel, entries[j]), mask);
+                __m128i error = _mm_madd_epi16(diff, diff);
+                error = _mm_add_epi32(error, _mm_shuffle_epi32(error, _MM_SHUFFLE(2, 3, 0, 1)));
+
+                const __m128i closer = _mm_cmplt_epi32(error, bestError);
+                bestError = _mm_or_si128(_mm_and_si128(closer, error), _mm_andnot_si128(closer, bestError));
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(j)), _mm_andnot_si128(closer, bestIndex));
+            }
+
+            indices[i] = static_cast<unsigned char>(_mm_cvtsi128_si32(bestIndex));
+            indices[i + 1] = static_cast<unsigned char>(_mm_cvtsi128_si32(_mm_srli_si128(bestIndex, 8)));
+            total += _mm_cvtsi128_si32(bestError) + _mm_cvtsi128_si32(_mm_srli_si128(bestError, 8));
+        }
+#else
+        const int channels = useAlpha ? 4 : 3;
+        for (int i = 0; i < 16; ++i)
+        {
+            int bestError = INT_MAX;
+            for (int j = 0; j < count; ++j)
+            {
+                int error = 0;
+                for (int c = 0; c < channels; ++c)
+                {
+                    const int diff = texels[i * 4 + c] - palette[j * 4 + c];
+                    error += diff * diff;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = static_cast<unsigned char>(j);
+                }
+            }
+            total += bestError;
+        }
+#endif
+        return total;
+    }
+
+    //----------------------------------------------------------------
+    // Mean and dominant direction of the first N channels of a block, by power iteration
+    template <int N>
+    void PrincipalAxis(const unsigned char* texels, float* mean, float* axis)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            mean[c] = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                mean[c] += texels[i * 4 + c];
+            }
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[N][N] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float diff[N];
+            for (int c = 0; c < N; ++c)
+            {
+                diff[c] = texels[i * 4 + c] - mean[c];
+            }
+            for (int a = 0; a < N; ++a)
+            {
+                for (int b = 0; b < N; ++b)
+                {
+                    covariance[a][b] += diff[a] * diff[b];
+                }
+            }
+        }
+
+        // Start from the row of the channel with the largest variance
+        int start = 0;
+        for (int c = 1; c < N; ++c)
+        {
+            if (covariance[c][c] > covariance[start][start])
+            {
+                start = c;
+            }
+        }
+        for (int c = 0; c < N; ++c)
+        {
+            axis[c] = covariance[start][c];
+        }
+
+        for (int iteration = 0; iteration < sPowerIterations; ++iteration)
+        {
+            float next[N] = {};
+            float largest = 0.0f;
+            for (int a = 0; a < N; ++a)
+            {
+                for (int b = 0; b < N; ++b)
+                {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                largest = std::max(largest, std::abs(next[a]));
+            }
+            if (largest < 1e-6f)
+            {
+                break;
+            }
+            for (int c = 0; c < N; ++c)
+            {
+                axis[c] = next[c] / largest;
+            }
+        }
+
+        float length = 0.0f;
+        for (int c = 0; c < N; ++c)
+        {
+            length += axis[c] * axis[c];
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < N; ++c)
+        {
+            axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+        }
+    }
+
+    //----------------------------------------------------------------
+    // Extremes of the block along its principal axis, pulled inwards by 1/inset of the range
+    template <int N>
+    void AxisEndpoints(const unsigned char* texels, const float inset, float* low, float* high)
+    {
+        float mean[N];
+        float axis[N];
+        PrincipalAxis<N>(texels, mean, axis);
+
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float projection = 0.0f;
+            for (int c = 0; c < N; ++c)
+            {
+                projection += (texels[i * 4 + c] - mean[c]) * axis[c];
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        const float margin = (maxProjection - minProjection) / inset;
+        for (int c = 0; c < N; ++c)
+        {
+            low[c] = std::min(std::max(mean[c] + axis[c] * (minProjection + margin), 0.0f), 255.0f);
+            high[c] = std::min(std::max(mean[c] + axis[c] * (maxProjection - margin), 0.0f), 255.0f);
+        }
+    }
+
+    //----------------------------------------------------------------
+    // Endpoints minimizing the squared error for fixed indices, false when the system is singular
+    template <int N>
+    const bool LeastSquares(const unsigned char* texels, const unsigned char* indices, const float* fractions, float* first, float* second)
+    {
+        float alpha2 = 0.0f;
+        float beta2 = 0.0f;
+        float alphaBeta = 0.0f;
+        float alphaX[N] = {};
+        float betaX[N] = {};
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const float beta = fractions[indices[i]];
+            const float alpha = 1.0f - beta;
+            alpha2 += alpha * alpha;
+            beta2 += beta * beta;
+            alphaBeta += alpha * beta;
+            for (int c = 0; c < N; ++c)
+            {
+                alphaX[c] += alpha * texels[i * 4 + c];
+                betaX[c] += beta * texels[i * 4 + c];
+            }
+        }
+
+        const float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return false;
+        }
+
+        for (int c = 0; c < N; ++c)
+        {
+            first[c] = std::min(std::max((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+            second[c] = std::min(std::max((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+        }
+        return true;
+    }
+
+    //----------------------------------------------------------------
+    inline void WriteLE16(unsigned char* out, const unsigned int value)
+    {
+        out[0] = static_cast<unsigned char>(value);
+        out[1] = static_cast<unsigned char>(value >> 8);
+    }
+
+    //----------------------------------------------------------------
+    inline const unsigned int ReadLE16(const unsigned char* in)
+    {
+        return in[0] | (in[1] << 8);
+    }
+
+    //**************** BC1 color ****************
+
+    //----------------------------------------------------------------
+    const unsigned int Pack565(const float* color)
+    {
+        const int r = Clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        const int g = Clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        const int b = Clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return (r << 11) | (g << 5) | b;
+    }
+
+    //----------------------------------------------------------------
+    void Unpack565(const unsigned int packed, unsigned char* color)
+    {
+        const int r = (packed >> 11) & 31;
+        const int g = (packed >> 5) & 63;
+        const int b = packed & 31;
+        color[0] = static_cast<unsigned char>((r << 3) | (r >> 2));
+        color[1] = static_cast<unsigned char>((g << 2) | (g >> 4));
+        color[2] = static_cast<unsigned char>((b << 3) | (b >> 2));
+        color[3] = 255;
+    }
+
+    //----------------------------------------------------------------
+    // Four color palette of a BC1 block, the three color mode is never encoded
+    void BC1Palette(const unsigned int color0, const unsigned int color1, unsigned char* palette)
+    {
+        Unpack565(color0, &palette[0]);
+        Unpack565(color1, &palette[4]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[8 + c] = static_cast<unsigned char>((2 * palette[c] + palette[4 + c]) / 3);
+            palette[12 + c] = static_cast<unsigned char>((palette[c] + 2 * palette[4 + c]) / 3);
+        }
+        palette[11] = 255;
+        palette[15] = 255;
+    }
+
+    //----------------------------------------------------------------
+    void EncodeBC1(const unsigned char* texels, unsigned char* out)
+    {
+        float low[3];
+        float high[3];
+        AxisEndpoints<3>(texels, 16.0f, low, high);
+
+        unsigned int bestColors[2] = { Pack565(high), Pack565(low) };
+        BlockFit best;
+        BC1Palette(bestColors[0], bestColors[1], best.palette);
+        best.error = FitIndices(texels, best.palette, 4, false, best.indices);
+
+        for (int iteration = 0; iteration < sRefineIterations && best.error > 0; ++iteration)
+        {
+            if (!LeastSquares<3>(texels, best.indices, sBC1Fractions, high, low))
+            {
+                break;
+            }
+
+            const unsigned int colors[2] = { Pack565(high), Pack565(low) };
+            BlockFit fit;
+            BC1Palette(colors[0], colors[1], fit.palette);
+            fit.error = FitIndices(texels, fit.palette, 4, false, fit.indices);
+            if (fit.error >= best.error)
+            {
+                break;
+            }
+            best = fit;
+            bestColors[0] = colors[0];
+            bestColors[1] = colors[1];
+        }
+
+        // The four color mode needs color0 > color1, swapping the endpoints mirrors the indices
+        unsigned int flip = 0;
+        if (bestColors[0] < bestColors[1])
+        {
+            std::swap(bestColors[0], bestColors[1]);
+            flip = 1;
+        }
+
+        unsigned int bits = 0;
+        if (bestColors[0] != bestColors[1])
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                bits |= (best.indices[i] ^ flip) << (i * 2);
+            }
+        }
+
+        WriteLE16(&out[0], bestColors[0]);
+        WriteLE16(&out[2], bestColors[1]);
+        WriteLE16(&out[4], bits & 0xFFFF);
+        WriteLE16(&out[6], bits >> 16);
+    }
+
+    //----------------------------------------------------------------
+    void DecodeBC1(const unsigned char* in, unsigned char* texels, const bool alwaysFourColors)
+    {
+        const unsigned int color0 = ReadLE16(&in[0]);
+        const unsigned int color1 = ReadLE16(&in[2]);
+        const unsigned int bits = ReadLE16(&in[4]) | (ReadLE16(&in[6]) << 16);
+
+        unsigned char palette[16];
+        BC1Palette(color0, color1, palette);
+        if (color0 <= color1 && !alwaysFourColors)
+        {
+            // Three colors plus transparent black
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[8 + c] = static_cast<unsigned char>((palette[c] + palette[4 + c]) / 2);
+            }
+            std::memset(&palette[12], 0, 4);
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            std::memcpy(&texels[i * 4], &palette[((bits >> (i * 2)) & 3) * 4], 4);
+        }
+    }
+
+    //**************** BC3 alpha ****************
+
+    //----------------------------------------------------------------
+    void AlphaPalette(const int alpha0, const int alpha1, int* palette)
+    {
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int k = 2; k < 8; ++k)
+        {
+            palette[k] = ((8 - k) * alpha0 + (k - 1) * alpha1 + 3) / 7;
+        }
+    }
+
+    //----------------------------------------------------------------
+    // Eight level alpha block, endpoints are the extremes of the block
+    void EncodeAlpha(const unsigned char* texels, unsigned char* out)
+    {
+        int alphaMin = 255;
+        int alphaMax = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            alphaMin = std::min(alphaMin, int(texels[i * 4 + 3]));
+            alphaMax = std::max(alphaMax, int(texels[i * 4 + 3]));
+        }
+
+        std::memset(out, 0, 8);
+        out[0] = static_cast<unsigned char>(alphaMax);
+        out[1] = static_cast<unsigned char>(alphaMin);
+        if (alphaMax == alphaMin)
+        {
+            return;
+        }
+
+        int palette[8];
+        AlphaPalette(alphaMax, alphaMin, palette);
+
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int bestIndex = 0;
+            int bestError = INT_MAX;
+            for (int k = 0; k < 8; ++k)
+            {
+                const int error = std::abs(texels[i * 4 + 3] - palette[k]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = k;
+                }
+            }
+            bits |= static_cast<std::uint64_t>(bestIndex) << (i * 3);
+        }
+
+        for (int b = 0; b < 6; ++b)
+        {
+            out[2 + b] = static_cast<unsigned char>(bits >> (b * 8));
+        }
+    }
+
+    //----------------------------------------------------------------
+    void DecodeAlpha(const unsigned char* in, unsigned char* texels)
+    {
+        int palette[8];
+        if (in[0] > in[1])
+        {
+            AlphaPalette(in[0], in[1], palette);
+        }
+        else
+        {
+            // Six interpolated levels plus fully transparent and opaque
+            palette[0] = in[0];
+            palette[1] = in[1];
+            for (int k = 2; k < 6; ++k)
+            {
+                palette[k] = ((6 - k) * in[0] + (k - 1) * in[1] + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        std::uint64_t bits = 0;
+        for (int b = 0; b < 6; ++b)
+        {
+            bits |= static_cast<std::uint64_t>(in[2 + b]) << (b * 8);
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 3] = static_cast<unsigned char>(palette[(bits >> (i * 3)) & 7]);
+        }
+    }
+
+    //**************** BC7 mode 6 ****************
+
+    /**
+     * @brief Little endian bit stream over one 128-bit block.
+     */
+    struct BitStream
+    {
+        unsigned char* data;
+        int position = 0;
+
+        explicit BitStream(unsigned char* data) : data(data) {}
+
+        void Write(const unsigned int value, const int bits)
+        {
+            for (int b = 0; b < bits; ++b, ++position)
+            {
+                data[position >> 3] |= static_cast<unsigned char>(((value >> b) & 1) << (position & 7));
+            }
+        }
+
+        const unsigned int Read(const int bits)
+        {
+            unsigned int value = 0;
+            for (int b = 0; b < bits; ++b, ++position)
+            {
+                value |= ((data[position >> 3] >> (position & 7)) & 1u) << b;
+            }
+            return value;
+        }
+    };
+
+    /**
+     * @brief One mode 6 endpoint: 7 bits per channel plus a shared low bit.
+     */
+    struct BC7Endpoint
+    {
+        int color[4];
+        int pBit;
+
+        const int Expand(const int c) const { return (color[c] << 1) | pBit; }
+    };
+
+    //----------------------------------------------------------------
+    const BC7Endpoint QuantizeBC7(const float* value)
+    {
+        BC7Endpoint best = {};
+        float bestError = -1.0f;
+        for (int pBit = 0; pBit < 2; ++pBit)
+        {
+            BC7Endpoint endpoint;
+            endpoint.pBit = pBit;
+            float error = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                endpoint.color[c] = Clamp(static_cast<int>((value[c] - pBit) * 0.5f + 0.5f), 0, 127);
+                const float diff = endpoint.Expand(c) - value[c];
+                error += diff * diff;
+            }
+            if (bestError < 0.0f || error < bestError)
+            {
+                best = endpoint;
+                bestError = error;
+            }
+        }
+        return best;
+    }
+
+    //----------------------------------------------------------------
+    void BC7Palette(const BC7Endpoint& first, const BC7Endpoint& second, unsigned char* palette)
+    {
+        for (int k = 0; k < 16; ++k)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                palette[k * 4 + c] = static_cast<unsigned char>(((64 - sBC7Weights[k]) * first.Expand(c) + sBC7Weights[k] * second.Expand(c) + 32) >> 6);
+            }
+        }
+    }
+
+    //----------------------------------------------------------------
+    void EncodeBC7(const unsigned char* texels, unsigned char* out)
+    {
+        float low[4];
+        float high[4];
+        AxisEndpoints<4>(texels, 32.0f, low, high);
+
+        BC7Endpoint endpoints[2] = { QuantizeBC7(low), QuantizeBC7(high) };
+        BlockFit best;
+        BC7Palette(endpoints[0], endpoints[1], best.palette);
+        best.error = FitIndices(texels, best.palette, 16, true, best.indices);
+
+        for (int iteration = 0; iteration < sRefineIterations && best.error > 0; ++iteration)
+        {
+            if (!LeastSquares<4>(texels, best.indices, sBC7Fractions, low, high))
+            {
+                break;
+            }
+
+            const BC7Endpoint refined[2] = { QuantizeBC7(low), QuantizeBC7(high) };
+            BlockFit fit;
+            BC7Palette(refined[0], refined[1], fit.palette);
+            fit.error = FitIndices(texels, fit.palette, 16, true, fit.indices);
+            if (fit.error >= best.error)
+            {
+                break;
+            }
+            best = fit;
+            endpoints[0] = refined[0];
+            endpoints[1] = refined[1];
+        }
+
+        // The first index is stored without its top bit, swapping the endpoints mirrors the indices
+        if (best.indices[0] & 8)
+        {
+            std::swap(endpoints[0], endpoints[1]);
+            for (int i = 0; i < 16; ++i)
+            {
+                best.indices[i] = static_cast<unsigned char>(15 - best.indices[i]);
+            }
+        }
+
+        std::memset(out, 0, 16);
+        BitStream stream(out);
+        stream.Write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            stream.Write(endpoints[0].color[c], 7);
+            stream.Write(endpoints[1].color[c], 7);
+        }
+        stream.Write(endpoints[0].pBit, 1);
+        stream.Write(endpoints[1].pBit, 1);
+        stream.Write(best.indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+        {
+            stream.Write(best.indices[i], 4);
+        }
+    }
+
+    //----------------------------------------------------------------
+    void DecodeBC7(const unsigned char* in, unsigned char* texels)
+    {
+        unsigned char block[16];
+        std::memcpy(block, in, 16);
+        BitStream stream(block);
+
+        if (stream.Read(7) != (1 << 6))
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                texels[i * 4 + 0] = 255;
+                texels[i * 4 + 1] = 0;
+                texels[i * 4 + 2] = 255;
+                texels[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        BC7Endpoint endpoints[2];
+        for (int c = 0; c < 4; ++c)
+        {
+            endpoints[0].color[c] = stream.Read(7);
+            endpoints[1].color[c] = stream.Read(7);
+        }
+        endpoints[0].pBit = stream.Read(1);
+        endpoints[1].pBit = stream.Read(1);
+
+        unsigned char palette[16 * 4];
+        BC7Palette(endpoints[0], endpoints[1], palette);
+        for (int i = 0; i < 16; ++i)
+        {
+            std::memcpy(&texels[i * 4], &palette[stream.Read(i == 0 ? 3 : 4) * 4], 4);
+        }
+    }
+} // namespace
+
+//----------------------------------------------------------------
+const size_t BlockBytes(const eTextureFormat format)
+{
+    switch (format)
+    {
+    case eTextureFormat::BC1:
+        return 8;
+    case eTextureFormat::BC3:
+    case eTextureFormat::BC7:
+        return 16;
+    case eTextureFormat::RGBA8:
+    default:
+        return 4;
+    }
+}
+
+//----------------------------------------------------------------
+const size_t ImageBytes(const eTextureFormat format, const int width, const int height)
+{
+    if (format == eTextureFormat::RGBA8)
+    {
+        return static_cast<size_t>(width) * height * 4;
+    }
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format);
+}
+
+//----------------------------------------------------------------
+void Encode(const unsigned char* rgba, const int width, const int height, const eTextureFormat format, unsigned char* blocks)
+{
+    if (format == eTextureFormat::RGBA8)
+    {
+        std::memcpy(blocks, rgba, ImageBytes(format, width, height));
+        return;
+    }
+
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockBytes = BlockBytes(format);
+
+    Core::JobPool::ParallelFor(blocksY, sBlockRowsPerJob, [&](const size_t begin, const size_t end)
+    {
+        unsigned char texels[16 * 4];
+        for (size_t blockY = begin; blockY < end; ++blockY)
+        {
+            for (int blockX = 0; blockX < blocksX; ++blockX)
+            {
+                FetchBlock(rgba, width, height, blockX, static_cast<int>(blockY), texels);
+                unsigned char* out = &blocks[(blockY * blocksX + blockX) * blockBytes];
+                switch (format)
+                {
+                case eTextureFormat::BC1:
+                    EncodeBC1(texels, out);
+                    break;
+                case eTextureFormat::BC3:
+                    EncodeAlpha(texels, out);
+                    EncodeBC1(texels, out + 8);
+                    break;
+                case eTextureFormat::BC7:
+                default:
+                    EncodeBC7(texels, out);
+                    break;
+                }
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------
+void Decode(const unsigned char* blocks, const int width, const int height, const eTextureFormat format, unsigned char* rgba)
+{
+    if (format == eTextureFormat::RGBA8)
+    {
+        std::memcpy(rgba, blocks, ImageBytes(format, width, height));
+        return;
+    }
+
+    const int blocksX = (width + 3) / 4;
+    const int blocksY = (height + 3) / 4;
+    const size_t blockBytes = BlockBytes(format);
+
+    Core::JobPool::ParallelFor(blocksY, sBlockRowsPerJob, [&](const size_t begin, const size_t end)
+    {
+        unsigned char texels[16 * 4];
+        for (size_t blockY = begin; blockY < end; ++blockY)
+        {
+            for (int blockX = 0; blockX < blocksX; ++blockX)
+            {
+                const unsigned char* in = &blocks[(blockY * blocksX + blockX) * blockBytes];
+                switch (format)
+                {
+                case eTextureFormat::BC1:
+                    DecodeBC1(in, texels, false);
+                    break;
+                case eTextureFormat::BC3:
+                    DecodeBC1(in + 8, texels, true);
+                    DecodeAlpha(in, texels);
+                    break;
+                case eTextureFormat::BC7:
+                default:
+                    DecodeBC7(in, texels);
+                    break;
+                }
+                StoreBlock(texels, width, height, blockX, static_cast<int>(blockY), rgba);
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------
+const double PSNR(const unsigned char* reference, const unsigned char* test, const size_t pixelCount, const bool ignoreAlpha /*= false*/)
+{
+    const int channels = ignoreAlpha ? 3 : 4;
+    double squaredError = 0.0;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            const double diff = double(reference[i * 4 + c]) - double(test[i * 4 + c]);
+            squaredError += diff * diff;
+        }
+    }
+
+    if (squaredError == 0.0 || pixelCount == 0)
+    {
+        return 999.0;
+    }
+
+    const double meanError = squaredError / (double(pixelCount) * channels);
+    return 10.0 * std::log10(255.0 * 255.0 / meanError);
+}
+
+//----------------------------------------------------------------
+const GLenum GetGLFormat(const eTextureFormat format, const bool srgb)
+{
+    switch (format)
+    {
+    case eTextureFormat::BC1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case eTextureFormat::BC3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case eTextureFormat::BC7:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+    case eTextureFormat::RGBA8:
+    default:
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+//----------------------------------------------------------------
+const bool IsSupportedByGL(const eTextureFormat format, const bool srgb)
+{
+    switch (format)
+    {
+    case eTextureFormat::BC1:
+    case eTextureFormat::BC3:
+        return GLAD_GL_EXT_texture_compression_s3tc != 0 && (!srgb || GLAD_GL_EXT_texture_sRGB != 0);
+    case eTextureFormat::BC7:
+        return GLAD_GL_ARB_texture_compression_bptc != 0;
+    case eTextureFormat::RGBA8:
+    default:
+        return true;
+    }
+}
+
+} // namespace BlockCompression
+} // namespace Graphic
+} // namespace Vision
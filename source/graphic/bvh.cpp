@@ -0,0 +1,481 @@
+#include <graphic/include/bvh.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//********************************
+//     Class BVH
+//********************************
+//----------------------------------------------------------------
+BVH::BVH()
+    : mNodes()
+    , mOrder()
+    , mItems()
+    , mLeaves()
+    , mMoved()
+    , mBuildItems()
+    , mCount(0)
+    , mStructureChanged(false)
+    , mSurfaceArea(0.0f)
+    , mBuiltSurfaceArea(0.0f)
+{}
+
+//----------------------------------------------------------------
+void BVH::Clear()
+{
+    mNodes.clear();
+    mOrder.clear();
+    mItems.clear();
+    mLeaves.clear();
+    mMoved.clear();
+    mBuildItems.clear();
+    mCount = 0;
+    mStructureChanged = false;
+    mSurfaceArea = 0.0f;
+    mBuiltSurfaceArea = 0.0f;
+}
+
+//----------------------------------------------------------------
+void BVH::Insert(const std::uint32_t id, const Bounds& bounds)
+{
+    if (id < mItems.size() && !mItems[id].IsEmpty())
+    {
+        Move(id, bounds);
+        return;
+    }
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    if (id >= mItems.size())
+    {
+        mItems.resize(id + 1);
+    }
+    mItems[id] = bounds;
+    mStructureChanged = true;
+}
+
+//----------------------------------------------------------------
+void BVH::Remove(const std::uint32_t id)
+{
+    if (id < mItems.size() && !mItems[id].IsEmpty())
+    {
+        mItems[id] = Bounds();
+        mStructureChanged = true;
+    }
+}
+
+//----------------------------------------------------------------
+void BVH::Move(const std::uint32_t id, const Bounds& bounds)
+{
+    if (id >= mItems.size() || mItems[id].IsEmpty())
+    {
+        Insert(id, bounds);
+        return;
+    }
+    if (bounds.IsEmpty())
+    {
+        Remove(id);
+        return;
+    }
+
+    mItems[id] = bounds;
+    mMoved.push_back(id);
+}
+
+//----------------------------------------------------------------
+void BVH::Refresh()
+{
+    if (!mStructureChanged)
+    {
+        for (const std::uint32_t id : mMoved)
+        {
+            Refit(id);
+        }
+    }
+    mMoved.clear();
+
+    // Refits only grow or shrink nodes in place, queries slow down as moved items spread out
+    if (mStructureChanged || mSurfaceArea > mBuiltSurfaceArea * sRebuildRatio)
+    {
+        Build();
+    }
+}
+
+//----------------------------------------------------------------
+void BVH::Build()
+{
+    mStructureChanged = false;
+    mNodes.clear();
+    mBuildItems.clear();
+    mLeaves.resize(mItems.size());
+    for (std::uint32_t id = 0; id < mItems.size(); ++id)
+    {
+        if (!mItems[id].IsEmpty())
+        {
+            mBuildItems.push_back({ mItems[id], mItems[id].GetCenter(), id });
+        }
+    }
+    mCount = static_cast<std::uint32_t>(mBuildItems.size());
+    mOrder.resize(mCount);
+    mSurfaceArea = 0.0f;
+    if (mCount == 0)
+    {
+        mBuiltSurfaceArea = 0.0f;
+        mOrder.clear();
+        return;
+    }
+
+    struct Pending
+    {
+        std::uint32_t node;
+        std::uint32_t depth;
+    };
+    std::vector<Pending> pending = { { 0, 0 } };
+    mNodes.reserve(2 * (mCount / sMaxLeafItems + 1));
+    mNodes.emplace_back();
+    mNodes[0].count = mCount;
+
+    while (!pending.empty())
+    {
+        const Pending current = pending.back();
+        pending.pop_back();
+
+        Node& node = mNodes[current.node];
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            node.bounds.Grow(mBuildItems[i].bounds);
+        }
+
+        const std::uint32_t leftCount = node.count > sMaxLeafItems && current.depth + 1 < sMaxDepth
+            ? Split(node.first, node.count)
+            : 0;
+        if (leftCount == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                mOrder[i] = mBuildItems[i].id;
+                mLeaves[mOrder[i]] = current.node;
+            }
+            continue;
+        }
+
+        mSurfaceArea += node.bounds.GetSurfaceArea();
+        const std::uint32_t first = node.first;
+        const std::uint32_t count = node.count;
+        const std::uint32_t left = static_cast<std::uint32_t>(mNodes.size());
+        node.left = left;
+
+        // node is invalidated by the growth
+        mNodes.resize(left + 2);
+        mNodes[left].first = first;
+        mNodes[left].count = leftCount;
+        mNodes[left + 1].first = first + leftCount;
+        mNodes[left + 1].count = count - leftCount;
+        for (std::uint32_t child = left; child < left + 2; ++child)
+        {
+            mNodes[child].parent = current.node;
+            pending.push_back({ child, current.depth + 1 });
+        }
+    }
+    mBuiltSurfaceArea = mSurfaceArea;
+    mBuildItems.clear();
+}
+
+//----------------------------------------------------------------
+const std::uint32_t BVH::Split(const std::uint32_t first, const std::uint32_t count)
+{
+    Bounds centers;
+    for (std::uint32_t i = first; i < first + count; ++i)
+    {
+        centers.Grow(mBuildItems[i].center);
+    }
+
+    // Items are binned by center along every axis at once, axes without extent are skipped
+    System::Types::Vector3 scale;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = centers.max[axis] - centers.min[axis];
+        scale[axis] = extent > 0.0f ? sBins / extent : 0.0f;
+    }
+    const auto GetBin = [&](const BuildItem& item, const int axis)
+    {
+        return std::min(sBins - 1, static_cast<std::uint32_t>((item.center[axis] - centers.min[axis]) * scale[axis]));
+    };
+
+    Bounds bins[3][sBins];
+    std::uint32_t counts[3][sBins] = {};
+    for (std::uint32_t i = first; i < first + count; ++i)
+    {
+        const BuildItem& item = mBuildItems[i];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const std::uint32_t bin = GetBin(item, axis);
+            bins[axis][bin].Grow(item.bounds);
+            ++counts[axis][bin];
+        }
+    }
+
+    // Cost of a split is the items on each side weighted by the chance to hit the side, its area
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    std::uint32_t bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (scale[axis] == 0.0f)
+        {
+            continue;
+        }
+
+        // Area and items left of every boundary, then swept from the right
+        float leftArea[sBins - 1];
+        std::uint32_t leftCount[sBins - 1];
+        Bounds side;
+        std::uint32_t sideCount = 0;
+        for (std::uint32_t bin = 0; bin < sBins - 1; ++bin)
+        {
+            side.Grow(bins[axis][bin]);
+            sideCount += counts[axis][bin];
+            leftArea[bin] = side.GetSurfaceArea();
+            leftCount[bin] = sideCount;
+        }
+        side = Bounds();
+        sideCount = 0;
+        for (std::uint32_t bin = sBins - 1; bin > 0; --bin)
+        {
+            side.Grow(bins[axis][bin]);
+            sideCount += counts[axis][bin];
+            const float cost = leftArea[bin - 1] * leftCount[bin - 1] + side.GetSurfaceArea() * sideCount;
+            if (leftCount[bin - 1] > 0 && sideCount > 0 && cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = bin - 1;
+            }
+        }
+    }
+
+    // Items all centered at the same point, any half is as good
+    if (bestAxis < 0)
+    {
+        return count / 2;
+    }
+
+    const auto begin = mBuildItems.begin() + first;
+    const auto middle = std::partition(begin, begin + count, [&](const BuildItem& item)
+    {
+        return GetBin(item, bestAxis) <= bestBin;
+    });
+    return static_cast<std::uint32_t>(middle - begin);
+}
+
+//----------------------------------------------------------------
+void BVH::Refit(const std::uint32_t id)
+{
+    std::uint32_t index = mLeaves[id];
+    while (true)
+    {
+        Node& node = mNodes[index];
+        Bounds bounds;
+        if (node.left == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                bounds.Grow(mItems[mOrder[i]]);
+            }
+        }
+        else
+        {
+            bounds.Grow(mNodes[node.left].bounds);
+            bounds.Grow(mNodes[node.left + 1].bounds);
+            mSurfaceArea += bounds.GetSurfaceArea() - node.bounds.GetSurfaceArea();
+        }
+
+        // Nodes above didn't change either
+        if (bounds.min == node.bounds.min && bounds.max == node.bounds.max)
+        {
+            return;
+        }
+        node.bounds = bounds;
+        if (index == 0)
+        {
+            return;
+        }
+        index = node.parent;
+    }
+}
+
+//----------------------------------------------------------------
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& ids) const
+{
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    std::uint32_t stack[sMaxDepth + 1];
+    std::uint32_t size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = mNodes[stack[--size]];
+        const Frustum::eOverlap overlap = frustum.Classify(node.bounds);
+        if (overlap == Frustum::eOverlap::OUTSIDE)
+        {
+            continue;
+        }
+        if (overlap == Frustum::eOverlap::INSIDE)
+        {
+            ids.insert(ids.end(), mOrder.begin() + node.first, mOrder.begin() + node.first + node.count);
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (frustum.Intersects(mItems[mOrder[i]]))
+                {
+                    ids.push_back(mOrder[i]);
+                }
+            }
+            continue;
+        }
+        stack[size++] = node.left + 1;
+        stack[size++] = node.left;
+    }
+}
+
+//----------------------------------------------------------------
+void BVH::QueryBounds(const Bounds& bounds, std::vector<std::uint32_t>& ids) const
+{
+    if (mNodes.empty() || bounds.IsEmpty())
+    {
+        return;
+    }
+
+    std::uint32_t stack[sMaxDepth + 1];
+    std::uint32_t size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = mNodes[stack[--size]];
+        if (!bounds.Overlaps(node.bounds))
+        {
+            continue;
+        }
+        if (bounds.Contains(node.bounds))
+        {
+            ids.insert(ids.end(), mOrder.begin() + node.first, mOrder.begin() + node.first + node.count);
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (bounds.Overlaps(mItems[mOrder[i]]))
+                {
+                    ids.push_back(mOrder[i]);
+                }
+            }
+            continue;
+        }
+        stack[size++] = node.left + 1;
+        stack[size++] = node.left;
+    }
+}
+
+//----------------------------------------------------------------
+void BVH::QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& ids) const
+{
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    const float radiusSquared = radius * radius;
+    std::uint32_t stack[sMaxDepth + 1];
+    std::uint32_t size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = mNodes[stack[--size]];
+        if (node.bounds.GetSquaredDistance(center) > radiusSquared)
+        {
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (mItems[mOrder[i]].GetSquaredDistance(center) <= radiusSquared)
+                {
+                    ids.push_back(mOrder[i]);
+                }
+            }
+            continue;
+        }
+        stack[size++] = node.left + 1;
+        stack[size++] = node.left;
+    }
+}
+
+//----------------------------------------------------------------
+const bool BVH::Raycast(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, RayHit& hit) const
+{
+    if (mNodes.empty())
+    {
+        return false;
+    }
+
+    const System::Types::Vector3 inverseDirection = 1.0f / direction;
+    float closest = maxDistance;
+    bool found = false;
+
+    std::uint32_t stack[sMaxDepth + 1];
+    std::uint32_t size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = mNodes[stack[--size]];
+        if (node.bounds.GetRayEntry(origin, inverseDirection, closest) < 0.0f)
+        {
+            continue;
+        }
+
+        if (node.left == 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                const float distance = mItems[mOrder[i]].GetRayEntry(origin, inverseDirection, closest);
+                if (distance >= 0.0f && (!found || distance < closest))
+                {
+                    closest = distance;
+                    hit.id = mOrder[i];
+                    hit.distance = distance;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // Nearest child on top, so it shortens the ray before the other is visited
+        const float leftEntry = mNodes[node.left].bounds.GetRayEntry(origin, inverseDirection, closest);
+        const float rightEntry = mNodes[node.left + 1].bounds.GetRayEntry(origin, inverseDirection, closest);
+        const bool leftFirst = rightEntry < 0.0f || (leftEntry >= 0.0f && leftEntry <= rightEntry);
+        stack[size++] = leftFirst ? node.left + 1 : node.left;
+        stack[size++] = leftFirst ? node.left : node.left + 1;
+    }
+    return found;
+}
+
+} // namespace Graphic
+} // namespace Vision
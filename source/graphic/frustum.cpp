@@ -0,0 +1,229 @@
+#include <graphic/include/frustum.h>
+
+#include <core/include/jobs.h>
+#include <core/include/simd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//********************************
+//     Class Frustum
+//********************************
+//----------------------------------------------------------------
+Frustum::Frustum(const System::Types::Matrix44& viewProjection)
+{
+    // Rows of the matrix, glm stores columns
+    const glm::mat4 rows = glm::transpose(viewProjection);
+    mPlanes[0] = rows[3] + rows[0];     // Left
+    mPlanes[1] = rows[3] - rows[0];     // Right
+    mPlanes[2] = rows[3] + rows[1];     // Bottom
+    mPlanes[3] = rows[3] - rows[1];     // Top
+    mPlanes[4] = rows[3] + rows[2];     // Near, GL clip depth goes from -w to w
+    mPlanes[5] = rows[3] - rows[2];     // Far
+
+    for (Vector4& plane : mPlanes)
+    {
+        plane /= glm::length(System::Types::Vector3(plane));
+    }
+}
+
+//----------------------------------------------------------------
+const Frustum::eOverlap Frustum::Classify(const Bounds& bounds) const
+{
+    if (bounds.IsEmpty())
+    {
+        return eOverlap::OUTSIDE;
+    }
+
+    const System::Types::Vector3 center = bounds.GetCenter();
+    const System::Types::Vector3 extent = bounds.GetExtent();
+    eOverlap overlap = eOverlap::INSIDE;
+    for (const Vector4& plane : mPlanes)
+    {
+        const System::Types::Vector3 normal(plane);
+        const float distance = glm::dot(normal, center) + plane.w;
+        const float radius = glm::dot(glm::abs(normal), extent);
+        if (distance + radius < 0.0f)
+        {
+            return eOverlap::OUTSIDE;
+        }
+        if (distance - radius < 0.0f)
+        {
+            overlap = eOverlap::PARTIAL;
+        }
+    }
+    return overlap;
+}
+
+namespace
+{
+#if defined(VISION_SIMD_AVX)
+    //----------------------------------------------------------------
+    // Visibility mask of the 8 boxes of a batch, one plane test per box and plane
+    VISION_SIMD_TARGET("avx") const int CullBatchAVX(const Frustum& frustum, const float* const centers[3], const float* const extents[3], const size_t base)
+    {
+        const __m256 x = _mm256_loadu_ps(centers[0] + base), y = _mm256_loadu_ps(centers[1] + base), z = _mm256_loadu_ps(centers[2] + base);
+        const __m256 sx = _mm256_loadu_ps(extents[0] + base), sy = _mm256_loadu_ps(extents[1] + base), sz = _mm256_loadu_ps(extents[2] + base);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int i = 0; i < 6; ++i)
+        {
+            const System::Types::Vector4& plane = frustum.GetPlane(i);
+            const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+                                                  _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+            const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, _mm256_set1_ps(std::fabs(plane.x))), _mm256_mul_ps(sy, _mm256_set1_ps(std::fabs(plane.y)))),
+                                                _mm256_mul_ps(sz, _mm256_set1_ps(std::fabs(plane.z))));
+            // NaN padding compares false, so it is never visible
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return _mm256_movemask_ps(inside);
+    }
+#endif
+} // namespace
+
+//********************************
+//     Class FrustumCuller
+//********************************
+//----------------------------------------------------------------
+void FrustumCuller::Resize(const size_t count)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        mCenters[axis].resize(count);
+        mExtents[axis].resize(count);
+    }
+    mIds.resize(count);
+}
+
+//----------------------------------------------------------------
+void FrustumCuller::Set(const size_t slot, const Bounds& bounds, const std::uint32_t id)
+{
+    // A NaN center fails every plane test
+    const bool empty = bounds.IsEmpty();
+    const System::Types::Vector3 center = empty ? System::Types::Vector3(std::numeric_limits<float>::quiet_NaN()) : bounds.GetCenter();
+    const System::Types::Vector3 extent = empty ? System::Types::Vector3(0.0f) : bounds.GetExtent();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        mCenters[axis][slot] = center[axis];
+        mExtents[axis][slot] = extent[axis];
+    }
+    mIds[slot] = id;
+}
+
+//----------------------------------------------------------------
+void FrustumCuller::CullBatches(const Frustum& frustum, const size_t firstBatch, const size_t lastBatch, std::vector<std::uint32_t>& visible) const
+{
+    const float* cx = mCenters[0].data();
+    const float* cy = mCenters[1].data();
+    const float* cz = mCenters[2].data();
+    const float* ex = mExtents[0].data();
+    const float* ey = mExtents[1].data();
+    const float* ez = mExtents[2].data();
+#if defined(VISION_SIMD_AVX)
+    const float* const centers[3] = { cx, cy, cz };
+    const float* const extents[3] = { ex, ey, ez };
+    const bool avx = Simd::HasAVX();
+#endif
+
+    for (size_t batch = firstBatch; batch < lastBatch; ++batch)
+    {
+        const size_t base = batch * sBatchSize;
+        int insideMask = 0;     // Bit i set if box base + i is visible
+
+#if defined(VISION_SIMD_AVX)
+        if (avx)
+        {
+            insideMask = CullBatchAVX(frustum, centers, extents, base);
+        }
+        else
+#endif
+        {
+#if defined(VISION_SIMD_SSE2)
+            for (size_t half = 0; half < sBatchSize; half += 4)
+            {
+                const size_t first = base + half;
+                const __m128 x = _mm_loadu_ps(cx + first), y = _mm_loadu_ps(cy + first), z = _mm_loadu_ps(cz + first);
+                const __m128 sx = _mm_loadu_ps(ex + first), sy = _mm_loadu_ps(ey + first), sz = _mm_loadu_ps(ez + first);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int i = 0; i < 6; ++i)
+                {
+                    const System::Types::Vector4& plane = frustum.GetPlane(i);
+                    const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                                                       _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                    const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(std::fabs(plane.x))), _mm_mul_ps(sy, _mm_set1_ps(std::fabs(plane.y)))),
+                                                     _mm_mul_ps(sz, _mm_set1_ps(std::fabs(plane.z))));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+                }
+                insideMask |= _mm_movemask_ps(inside) << half;
+            }
+#else
+            for (size_t i = 0; i < sBatchSize; ++i)
+            {
+                const size_t box = base + i;
+                bool inside = true;
+                for (int p = 0; p < 6 && inside; ++p)
+                {
+                    const System::Types::Vector4& plane = frustum.GetPlane(p);
+                    const float distance = cx[box] * plane.x + cy[box] * plane.y + cz[box] * plane.z + plane.w;
+                    const float radius = ex[box] * std::fabs(plane.x) + ey[box] * std::fabs(plane.y) + ez[box] * std::fabs(plane.z);
+                    inside = distance + radius >= 0.0f;     // False for NaN
+                }
+                insideMask |= inside ? 1 << i : 0;
+            }
+#endif
+        }
+
+        for (size_t i = 0; insideMask != 0; ++i, insideMask >>= 1)
+        {
+            if (insideMask & 1)
+            {
+                visible.push_back(mIds[base + i]);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const std::vector<std::uint32_t>& FrustumCuller::Cull(const Frustum& frustum)
+{
+    const size_t count = mIds.size();
+    const size_t batchCount = (count + sBatchSize - 1) / sBatchSize;
+
+    // The last batch is padded with boxes that can't be visible, removed again after the cull
+    const size_t padded = batchCount * sBatchSize;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        mCenters[axis].resize(padded, std::numeric_limits<float>::quiet_NaN());
+        mExtents[axis].resize(padded, 0.0f);
+    }
+    mIds.resize(padded, 0);
+
+    // Every job fills the list of its first batch, merged in job order so the result doesn't
+    // depend on threads. A pool without workers runs a single job for all of them.
+    const size_t jobCount = (batchCount + sBatchesPerJob - 1) / sBatchesPerJob;
+    mJobVisible.resize(std::max(mJobVisible.size(), jobCount));
+    for (size_t job = 0; job < jobCount; ++job)
+    {
+        mJobVisible[job].clear();
+    }
+    Core::JobPool::ParallelFor(batchCount, sBatchesPerJob, [this, &frustum](const size_t begin, const size_t end)
+    {
+        CullBatches(frustum, begin, end, mJobVisible[begin / sBatchesPerJob]);
+    });
+
+    mVisible.clear();
+    for (size_t job = 0; job < jobCount; ++job)
+    {
+        mVisible.insert(mVisible.end(), mJobVisible[job].begin(), mJobVisible[job].end());
+    }
+
+    Resize(count);
+    return mVisible;
+}
+
+} // namespace Graphic
+} // namespace Vision
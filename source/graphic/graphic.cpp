@@ -1,11 +1,16 @@
 #include <graphic/include/graphic.h>
 #include "fileManager.h"
+#include <system/include/glState.h>
+#include <cstdio>
+#include <filesystem>
 #include <sstream>
 
 namespace Vision
 {
 namespace Graphic
 {
+std::atomic<std::uint64_t> GraphicData::mNextVersion(0);
+
 //********************************
 //     Class GraphicData
 //********************************
@@ -15,6 +20,9 @@ GraphicData::GraphicData()
     , mIndices()
     , mTextures()
     , mMatrixTransform(1.0f)
+    , mVersion(++mNextVersion)
+    , mBounds()
+    , mBoundsVersion(0)
 {}
 
 //----------------------------------------------------------------
@@ -23,6 +31,9 @@ GraphicData::GraphicData(std::initializer_list<GLfloat> vertices, std::initializ
     , mIndices(indices)
     , mTextures()
     , mMatrixTransform(1.0f)
+    , mVersion(++mNextVersion)
+    , mBounds()
+    , mBoundsVersion(0)
 {
     if (texturePaths.size() > 0)
     {
@@ -33,9 +44,58 @@ GraphicData::GraphicData(std::initializer_list<GLfloat> vertices, std::initializ
     }
 }
 
+//----------------------------------------------------------------
+GraphicData::GraphicData(const GraphicData& other)
+    : mDrawMode(other.mDrawMode)
+    , mVertices(other.mVertices)
+    , mIndices(other.mIndices)
+    , mTextures(other.mTextures)
+    , mMatrixTransform(other.mMatrixTransform)
+    , mVersion(other.mVersion)
+    , mBounds(other.mBounds)
+    , mBoundsVersion(other.mBoundsVersion)
+{
+    for (TextureInfo* texture : mTextures)
+    {
+        TextureLoader::RetainTexture(*texture);
+    }
+}
+
+//----------------------------------------------------------------
+GraphicData& GraphicData::operator=(const GraphicData& other)
+{
+    if (this != &other)
+    {
+        // Retain first, in case both share the same textures
+        for (TextureInfo* texture : other.mTextures)
+        {
+            TextureLoader::RetainTexture(*texture);
+        }
+        for (TextureInfo* texture : mTextures)
+        {
+            TextureLoader::ReleaseTexture(*texture);
+        }
+
+        mDrawMode = other.mDrawMode;
+        mVertices = other.mVertices;
+        mIndices = other.mIndices;
+        mTextures = other.mTextures;
+        mMatrixTransform = other.mMatrixTransform;
+        mVersion = other.mVersion;
+        mBounds = other.mBounds;
+        mBoundsVersion = other.mBoundsVersion;
+    }
+    return *this;
+}
+
 //----------------------------------------------------------------
 GraphicData::~GraphicData()
 {
+    for (TextureInfo* texture : mTextures)
+    {
+        TextureLoader::ReleaseTexture(*texture);
+    }
+
     mVertices.clear();
     mIndices.clear();
     mTextures.clear();
@@ -48,6 +108,7 @@ void GraphicData::AddVertex(std::initializer_list<System::Types::Float> vertex)
     {
         mVertices.push_back(v);
     }
+    Touch();
 }
 
 //----------------------------------------------------------------
@@ -57,6 +118,7 @@ void GraphicData::AddIndex(std::initializer_list<System::Types::UInt> index)
     {
         mIndices.push_back(i);
     }
+    Touch();
 }
 
 //----------------------------------------------------------------
@@ -66,27 +128,108 @@ void GraphicData::AddTexture(const char* texturePath)
 }
 
 //----------------------------------------------------------------
-void GraphicData::SetBuffers(GLuint& vertexBuffer, GLuint& elementBuffer) const
+const Bounds& GraphicData::GetBounds() const
 {
-    using namespace System;
-    // feed Vertex Buffer
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, mVertices.size() * Types::VertexConst::sVertexElementInBytes, mVertices.data(), GL_STATIC_DRAW);
-    // feed Element Buffer
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mIndices.size() * Types::VertexConst::sIndexElementBytes, mIndices.data(), GL_STATIC_DRAW);
+    if (mBoundsVersion != mVersion)
+    {
+        using namespace System::Types::VertexConst;
 
+        mBounds = Bounds();
+        for (size_t vertex = 0; vertex + SIZE <= mVertices.size(); vertex += SIZE)
+        {
+            mBounds.Grow(System::Types::Vector3(mVertices[vertex + POINT_X], mVertices[vertex + POINT_Y], mVertices[vertex + POINT_Z]));
+        }
+        mBoundsVersion = mVersion;
+    }
+    return mBounds;
+}
+
+//----------------------------------------------------------------
+void GraphicData::BindTextures() const
+{
     const size_t nTextures = mTextures.size();
 
     assert(nTextures < 32);
 
     for (int i = 0; i < nTextures; ++i)
     {
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(GL_TEXTURE_2D, mTextures.at(i)->id);
+        System::GLState::BindTexture(static_cast<GLuint>(i), GL_TEXTURE_2D, mTextures.at(i)->id);
     }
 }
 
+//----------------------------------------------------------------
+const bool GraphicData::HasSameTextures(const GraphicData& other) const
+{
+    if (mTextures.size() != other.mTextures.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < mTextures.size(); ++i)
+    {
+        if (mTextures.at(i)->id != other.mTextures.at(i)->id)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+const std::uint32_t GraphicData::GetMaterialID() const
+{
+    std::uint64_t hash = Util::sHashSeed;
+    for (const System::Types::TextureInfo* texture : mTextures)
+    {
+        hash = Util::HashBytes(&texture->id, sizeof(texture->id), hash);
+    }
+    // Render keys keep only the low bits, fold the high ones into them
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+//----------------------------------------------------------------
+const bool GraphicData::ApplyAtlas()
+{
+    using namespace System::Types;
+
+    // There is a single set of texture coordinates, so only one texture can be moved to an atlas
+    for (TextureInfo*& texture : mTextures)
+    {
+        const AtlasRegion* region = TextureLoader::FindAtlasRegion(texture->name.c_str());
+        TextureInfo* page = region != nullptr ? TextureLoader::FindTexture(region->page.c_str()) : nullptr;
+        if (page == nullptr)
+        {
+            continue;
+        }
+
+        // Coordinates outside [0, 1] rely on GL_REPEAT, which can't be reproduced inside a page
+        for (size_t v = 0; v + VertexConst::SIZE <= mVertices.size(); v += VertexConst::SIZE)
+        {
+            const Float u = mVertices[v + VertexConst::TEX_X];
+            const Float t = mVertices[v + VertexConst::TEX_Y];
+            if (u < 0.0f || u > 1.0f || t < 0.0f || t > 1.0f)
+            {
+                LOG_STDERR("Texture '" << texture->name << "' is repeated, it can't be moved to atlas '" << region->page << "'.");
+                return false;
+            }
+        }
+
+        for (size_t v = 0; v + VertexConst::SIZE <= mVertices.size(); v += VertexConst::SIZE)
+        {
+            mVertices[v + VertexConst::TEX_X] = region->uvOffset.x + mVertices[v + VertexConst::TEX_X] * region->uvScale.x;
+            mVertices[v + VertexConst::TEX_Y] = region->uvOffset.y + mVertices[v + VertexConst::TEX_Y] * region->uvScale.y;
+        }
+        Touch();
+
+        TextureLoader::RetainTexture(*page);
+        TextureLoader::ReleaseTexture(*texture);
+        texture = page;
+        return true;
+    }
+
+    return false;
+}
+
 /**
 * @brief Reads 3D data from .OBJ files.
 */
@@ -139,62 +282,277 @@ class GraphicDataFile : Util::File<GraphicData>
 //     Class TextureLoader
 //********************************
 
-Graphic::TextureLoader* TextureLoader::mInstance = new TextureLoader();
 //----------------------------------------------------------------
 TextureLoader::TextureLoader()
     : mTextureList()
 {
 }
 
+//----------------------------------------------------------------
+TextureLoader& TextureLoader::Get()
+{
+    // Never destroyed, textures may still be released by other static objects at exit
+    static TextureLoader* instance = new TextureLoader();
+    return *instance;
+}
+
 //----------------------------------------------------------------
 System::Types::TextureInfo& TextureLoader::iAddTexture(const char* path, const char* name /*= "unnamed"*/)
 {
+    TextureMap& texList = Get().mTextureList;
+    TextureAliasMap& pathList = Get().mPathList;
+
+    // Same file already loaded: share it without decoding again.
+    const std::string canonical = CanonicalPath(path);
+    auto alias = pathList.find(canonical);
+    if (alias != pathList.end())
+    {
+        TextureInfo& texture = *texList.at(alias->second);
+        ++texture.refCount;
+        return texture;
+    }
+
+    std::unique_ptr<TextureInfo> loaded;
+    if (TextureCook::IsCookedPath(path))
+    {
+        loaded.reset(new TextureInfo());
+        if (!TextureCook::Load(*loaded, path))
+        {
+            loaded->id = -1;
+        }
+    }
+    else
+    {
+        loaded.reset(new TextureInfo(path));
+    }
+
+    return Register(std::move(loaded), canonical, name);
+}
+
+//----------------------------------------------------------------
+System::Types::TextureInfo& TextureLoader::iAddTexture(std::unique_ptr<TextureInfo> texture, const char* name /*= "unnamed"*/)
+{
+    return Register(std::move(texture), std::string(), name);
+}
+
+//----------------------------------------------------------------
+void TextureLoader::iRetainTexture(TextureInfo& texture)
+{
+    ++texture.refCount;
+}
+
+//----------------------------------------------------------------
+const bool TextureLoader::iReleaseTexture(TextureInfo& texture)
+{
+    TextureMap& texList = Get().mTextureList;
+
+    auto entry = texList.find(texture.name);
+    if (entry == texList.end() || entry->second.get() != &texture)
+    {
+        return false;
+    }
+
+    if (--texture.refCount == 0)
+    {
+        Get().Destroy(entry);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+const bool TextureLoader::iRemoveTexture(const char* name)
+{
+    TextureMap& texList = Get().mTextureList;
+
+    auto entry = texList.find(name);
+    if (entry != texList.end())
+    {
+        return iReleaseTexture(*entry->second);
+    }
+    return false;
+}
+
+//----------------------------------------------------------------
+const GLuint TextureLoader::iGetTexture(const char* name)
+{
+    auto tex = Get().mTextureList.find(name);
+    if (tex != Get().mTextureList.end())
+    {
+        return tex->second->id;
+    }
+
+    return -1;
+}
+
+//----------------------------------------------------------------
+TextureMap& TextureLoader::iGetTextureList()
+{
+    return Get().mTextureList;
+}
+
+//----------------------------------------------------------------
+TextureInfo* TextureLoader::iFindTexture(const char* name)
+{
+    auto tex = Get().mTextureList.find(name);
+    return tex != Get().mTextureList.end() ? tex->second.get() : nullptr;
+}
+
+//----------------------------------------------------------------
+void TextureLoader::iSetAtlasRegion(const char* name, const AtlasRegion& region)
+{
+    Get().mAtlasList[name] = region;
+}
+
+//----------------------------------------------------------------
+const AtlasRegion* TextureLoader::iFindAtlasRegion(const char* name)
+{
+    auto region = Get().mAtlasList.find(name);
+    return region != Get().mAtlasList.end() ? &region->second : nullptr;
+}
+
+//----------------------------------------------------------------
+TextureInfo& TextureLoader::Register(std::unique_ptr<TextureInfo> loaded, const std::string& canonical, const char* name)
+{
+    TextureMap& texList = Get().mTextureList;
+    TextureAliasMap& pathList = Get().mPathList;
+    TextureHashMap& hashList = Get().mHashList;
+
+    // Different file, same pixels: keep the existing copy and remember this path too.
+    if (loaded->CheckInfo())
+    {
+        loaded->contentHash = ContentHash(*loaded);
+        auto duplicate = hashList.find(loaded->contentHash);
+        if (duplicate != hashList.end())
+        {
+            if (!canonical.empty())
+            {
+                pathList[canonical] = duplicate->second;
+            }
+
+            TextureInfo& texture = *texList.at(duplicate->second);
+            ++texture.refCount;
+            return texture;
+        }
+    }
+
     // No repeated names allowed, automatically renamed at this point.
     std::string rename(name);
     int renameIndex = 1;
-    TextureMap& texList = mInstance->mTextureList;
 
     while (texList.find(rename) != texList.end())
     {
         rename.assign(name);
         rename.append(std::to_string(renameIndex++));
     }
-    // emplace
-    texList[rename] = *new System::Types::TextureInfo(path);
 
-    return texList[rename];
+    loaded->name = rename;
+    loaded->refCount = 1;
+    if (loaded->CheckInfo())
+    {
+        Cook(*loaded, canonical);
+
+        if (!canonical.empty())
+        {
+            pathList[canonical] = rename;
+        }
+        hashList[loaded->contentHash] = rename;
+    }
+
+    TextureInfo& texture = *loaded;
+    texList[rename] = std::move(loaded);
+
+    return texture;
 }
 
+//----------------------------------------------------------------
+const std::string TextureLoader::CanonicalPath(const char* path)
+{
+    std::error_code error;
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+
+    return error ? std::string(path) : canonical.string();
+}
 
 //----------------------------------------------------------------
-const bool TextureLoader::iRemoveTexture(const char* name)
+const std::uint64_t TextureLoader::ContentHash(const TextureInfo& texture)
 {
-    TextureMap& texList = mInstance->mTextureList;
+    const int header[] = { texture.width, texture.height, texture.nrChannels, static_cast<int>(texture.format) };
 
-    if (texList.find(name) != texList.end())
+    const std::uint64_t hash = Util::HashBytes(header, sizeof(header));
+    if (texture.IsCooked())
     {
-        texList.erase(name);
-        return true;
+        const std::vector<unsigned char>& base = texture.levels.front().data;
+        return Util::HashBytes(base.data(), base.size(), hash);
     }
-    return false;
+    return Util::HashBytes(texture.data, texture.GetByteSize(), hash);
 }
 
 //----------------------------------------------------------------
-const GLuint TextureLoader::iGetTexture(const char* name)
+void TextureLoader::Cook(TextureInfo& texture, const std::string& canonical)
 {
-    auto tex = mInstance->mTextureList.find(name);
-    if (tex != mInstance->mTextureList.end())
+    const TextureCook::Settings& settings = Get().mCookSettings;
+
+    // Textures read cooked or made in memory have no image file to keep the result next to
+    if (texture.IsCooked() || canonical.empty())
     {
-        return tex->second.id;
+        TextureCook::Cook(texture, settings);
+        return;
     }
 
-    return -1;
+    std::error_code error;
+    const std::string cooked = CookedPath(canonical, texture.contentHash, settings);
+    if (std::filesystem::exists(cooked, error) && TextureCook::Load(texture, cooked.c_str()))
+    {
+        stbi_image_free(texture.data);
+        texture.data = NULL;
+        return;
+    }
+
+    TextureCook::Cook(texture, settings);
+    std::filesystem::create_directories(std::filesystem::path(cooked).parent_path(), error);
+    TextureCook::Save(texture, cooked.c_str());
 }
 
 //----------------------------------------------------------------
-TextureMap& TextureLoader::iGetTextureList()
+const std::string TextureLoader::CookedPath(const std::string& canonical, const std::uint64_t contentHash, const TextureCook::Settings& settings)
+{
+    // Other settings cook other chains from the same pixels
+    const int options[] = { settings.generateMips, static_cast<int>(settings.compression), static_cast<int>(settings.mips.filter),
+                            settings.mips.gammaCorrect, settings.mips.wrap };
+    std::uint64_t hash = Util::HashBytes(options, sizeof(options), contentHash);
+    hash = Util::HashBytes(&settings.minPSNR, sizeof(settings.minPSNR), hash);
+
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    const std::filesystem::path directory = std::filesystem::path(canonical).parent_path() / TextureCook::sCookedDirectory;
+    return (directory / (std::string(name) + TextureCook::sCookedExtension)).string();
+}
+
+//----------------------------------------------------------------
+void TextureLoader::Destroy(TextureMap::iterator entry)
 {
-    return mInstance->mTextureList;
+    TextureInfo& texture = *entry->second;
+
+    // The GL side may already be gone when the last user is a static being destroyed.
+    if (texture.IsUploaded() && SDL_GL_GetCurrentContext() != nullptr)
+    {
+        System::GLState::DeleteTexture(texture.id);
+    }
+
+    for (auto alias = mPathList.begin(); alias != mPathList.end();)
+    {
+        alias = (alias->second == texture.name) ? mPathList.erase(alias) : std::next(alias);
+    }
+
+    auto hash = mHashList.find(texture.contentHash);
+    if (hash != mHashList.end() && hash->second == texture.name)
+    {
+        mHashList.erase(hash);
+    }
+
+    mAtlasList.erase(texture.name);
+
+    mTextureList.erase(entry);
 }
 
 } // namespace Graphic 
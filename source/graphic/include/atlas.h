@@ -0,0 +1,94 @@
+#pragma once
+
+#include <graphic/include/graphic.h>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Packs textures of the TextureLoader into a few large atlas pages.
+ *
+ * Textures are packed with a skyline bottom-left packer, each surrounded by a gutter of
+ * repeated edge texels so lower mip levels don't bleed into their neighbours. Pages are added
+ * to the TextureLoader and every packed texture gets its AtlasRegion recorded there, so
+ * GraphicData::ApplyAtlas can rewrite texture coordinates to the page.
+ */
+class AtlasBuilder
+{
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page
+    {
+        std::vector<SkylineNode> skyline;
+        int usedHeight = 0;
+    };
+
+    struct Entry
+    {
+        std::string texture;
+        int width = 0;      // Size of the texture
+        int height = 0;
+        int slotWidth = 0;  // Size of the texture plus gutter, rounded to 4x4 blocks
+        int slotHeight = 0;
+        int page = -1;
+        int x = 0;          // Position of the slot in its page
+        int y = 0;
+    };
+
+    int mPageSize;
+    int mPadding;
+    std::vector<Entry> mEntries;
+    std::vector<std::string> mPageNames;
+
+    const bool Fit(const Page& page, const size_t node, const int width, const int height, int& y) const;
+    const bool Insert(Page& page, const int width, const int height, int& x, int& y) const;
+    void Blit(const Entry& entry, const TextureInfo& source, std::vector<unsigned char>& pixels, const int pageWidth) const;
+
+public:
+    /**
+     * @param[in] pageSize Width and maximum height of every page, in texels.
+     * @param[in] padding Gutter around every texture, in texels.
+     */
+    AtlasBuilder(const int pageSize = 2048, const int padding = 8);
+
+    /**
+     * @brief Queues a texture of the TextureLoader to be packed.
+     */
+    void Add(const char* textureName);
+
+    /**
+     * @brief Packs every queued texture, adds the pages to the TextureLoader and records the regions.
+     *
+     * Textures larger than a page are left out.
+     *
+     * @param[in] pageName Base name of the page textures, an index is appended.
+     * @return Number of pages created.
+     */
+    const size_t Build(const char* pageName = "atlas");
+
+    /**
+     * @brief Writes the built pages as .vtex files next to a manifest of the regions.
+     *
+     * @return True if every file was written.
+     */
+    const bool Save(const char* manifestPath) const;
+
+    /**
+     * @brief Loads pages and regions written by Save into the TextureLoader.
+     *
+     * @return True if the manifest and every page were read.
+     */
+    static const bool Load(const char* manifestPath);
+};
+
+} // namespace Graphic
+} // namespace Vision
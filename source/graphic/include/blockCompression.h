@@ -0,0 +1,71 @@
+#pragma once
+
+#include <system/include/types.h>
+#include <cstddef>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace BlockCompression
+{
+
+/**
+ * @brief Size in bytes of one 4x4 block, or of one texel for RGBA8.
+ */
+const size_t BlockBytes(const System::Types::eTextureFormat format);
+
+/**
+ * @brief Size in bytes of an image of the given size, partial blocks on the edges count as whole ones.
+ */
+const size_t ImageBytes(const System::Types::eTextureFormat format, const int width, const int height);
+
+/**
+ * @brief Compresses an RGBA image to BC1, BC3 or BC7.
+ *
+ * Endpoints are fitted along the principal axis of every block and refined by least squares.
+ * BC7 is only encoded in mode 6 (one subset, RGBA, 4-bit indices). Rows of blocks are split
+ * across the Core::JobPool; edge blocks repeat the closest texels.
+ *
+ * @param[in] rgba The image, 4 bytes per pixel, tightly packed.
+ * @param[in] width Width of the image in pixels.
+ * @param[in] height Height of the image in pixels.
+ * @param[in] format Block format to encode.
+ * @param[out] blocks Destination, ImageBytes(format, width, height) bytes.
+ */
+void Encode(const unsigned char* rgba, const int width, const int height, const System::Types::eTextureFormat format, unsigned char* blocks);
+
+/**
+ * @brief Decompresses BC1, BC3 or BC7 blocks to an RGBA image.
+ *
+ * Only BC7 mode 6 blocks are decoded, other modes come out magenta.
+ *
+ * @param[in] blocks Source blocks, as written by Encode.
+ * @param[in] width Width of the image in pixels.
+ * @param[in] height Height of the image in pixels.
+ * @param[in] format Block format of the source.
+ * @param[out] rgba Destination, 4 bytes per pixel, tightly packed.
+ */
+void Decode(const unsigned char* blocks, const int width, const int height, const System::Types::eTextureFormat format, unsigned char* rgba);
+
+/**
+ * @brief Peak signal to noise ratio between two RGBA images, in dB.
+ *
+ * @param[in] ignoreAlpha Compare the color channels only.
+ * @return The PSNR, or a large value when the images are identical.
+ */
+const double PSNR(const unsigned char* reference, const unsigned char* test, const size_t pixelCount, const bool ignoreAlpha = false);
+
+/**
+ * @brief Compressed internal format for glCompressedTexImage2D.
+ */
+const GLenum GetGLFormat(const System::Types::eTextureFormat format, const bool srgb);
+
+/**
+ * @brief Whether the current GL context can sample the format without decompressing it on the CPU.
+ */
+const bool IsSupportedByGL(const System::Types::eTextureFormat format, const bool srgb);
+
+} // namespace BlockCompression
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <system/include/types.h>
+#include <algorithm>
+#include <limits>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Axis aligned bounding box. Starts empty, min above max, so any point grows it.
+ */
+struct Bounds
+{
+    using Vector = System::Types::Vector3;
+
+    Vector min = Vector(std::numeric_limits<float>::max());
+    Vector max = Vector(-std::numeric_limits<float>::max());
+
+    inline const bool IsEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    inline const Vector GetCenter() const { return (min + max) * 0.5f; }
+    inline const Vector GetExtent() const { return (max - min) * 0.5f; }
+
+    inline const bool Overlaps(const Bounds& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x
+            && min.y <= other.max.y && max.y >= other.min.y
+            && min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    inline const bool Contains(const Bounds& other) const
+    {
+        return min.x <= other.min.x && max.x >= other.max.x
+            && min.y <= other.min.y && max.y >= other.max.y
+            && min.z <= other.min.z && max.z >= other.max.z;
+    }
+
+    // 0 for points inside
+    inline const float GetSquaredDistance(const Vector& point) const
+    {
+        const Vector outside = glm::max(glm::max(min - point, point - max), Vector(0.0f));
+        return glm::dot(outside, outside);
+    }
+
+    // Distance along the ray to where it enters the box, 0 if it starts inside, negative if it misses it
+    inline const float GetRayEntry(const Vector& origin, const Vector& inverseDirection, const float maxDistance) const
+    {
+        const Vector toMin = (min - origin) * inverseDirection;
+        const Vector toMax = (max - origin) * inverseDirection;
+        const Vector entry = glm::min(toMin, toMax);
+        const Vector exit = glm::max(toMin, toMax);
+        const float enter = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+        const float leave = std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+        return enter <= leave ? enter : -1.0f;
+    }
+
+    inline const float GetSurfaceArea() const
+    {
+        if (IsEmpty())
+        {
+            return 0.0f;
+        }
+        const Vector size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline void Grow(const Vector& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    inline void Grow(const Bounds& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    /**
+     * @brief Box around this one once transformed, tight for the box but not for its content.
+     *
+     * The extent of the result is the extent projected on every axis by the absolute rotation
+     * and scale of the matrix.
+     */
+    const Bounds Transformed(const System::Types::Matrix44& matrix) const
+    {
+        if (IsEmpty())
+        {
+            return *this;
+        }
+
+        const Vector center = Vector(matrix * System::Types::Vector4(GetCenter(), 1.0f));
+        const Vector extent = GetExtent();
+        Vector worldExtent(0.0f);
+        for (int column = 0; column < 3; ++column)
+        {
+            worldExtent += glm::abs(Vector(matrix[column])) * extent[column];
+        }
+
+        Bounds result;
+        result.min = center - worldExtent;
+        result.max = center + worldExtent;
+        return result;
+    }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <graphic/include/frustum.h>
+#include <graphic/include/spatialIndex.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Bounding volume hierarchy over the bounds of items with dense ids.
+ *
+ * Built top-down with a binned surface area heuristic. Moving an item only refits the nodes
+ * above its leaf; inserting or removing one, or refits inflating the tree past
+ * sRebuildRatio times its built surface area, rebuilds it. Changes are applied by Refresh,
+ * queries see the tree as of the last Refresh and return ids in tree order.
+ */
+class BVH : public ISpatialIndex
+{
+    static const std::uint32_t sMaxLeafItems = 4;
+    static const std::uint32_t sBins = 16;
+    static const std::uint32_t sMaxDepth = 64;
+    static constexpr float sRebuildRatio = 1.5f;
+
+    // Copy of an item, so the build reads memory in order
+    struct BuildItem
+    {
+        Bounds bounds;
+        System::Types::Vector3 center;
+        std::uint32_t id;
+    };
+
+    struct Node
+    {
+        Bounds bounds;
+        std::uint32_t first = 0;    // First item of the node in mOrder, a subtree covers a range
+        std::uint32_t count = 0;    // Items under the node
+        std::uint32_t left = 0;     // First child, the second follows it; 0 for leaves
+        std::uint32_t parent = 0;
+    };
+
+    std::vector<Node> mNodes;
+    std::vector<std::uint32_t> mOrder;      // Ids sorted by leaf
+    std::vector<Bounds> mItems;             // Bounds by id, empty if the id isn't in the tree
+    std::vector<std::uint32_t> mLeaves;     // Leaf of every id in the tree
+    std::vector<std::uint32_t> mMoved;      // Ids moved since the last Refresh
+    std::vector<BuildItem> mBuildItems;     // Items being built, partitioned in place
+    std::uint32_t mCount;
+    bool mStructureChanged;
+    float mSurfaceArea;                     // Sum over the interior nodes, grows with refits
+    float mBuiltSurfaceArea;
+
+    void Build();
+    // Partitions the items of a node in two, returns how many go left
+    const std::uint32_t Split(const std::uint32_t first, const std::uint32_t count);
+    void Refit(const std::uint32_t id);
+
+public:
+    BVH();
+
+    void Clear();
+    void Insert(const std::uint32_t id, const Bounds& bounds);
+    void Remove(const std::uint32_t id);
+    void Move(const std::uint32_t id, const Bounds& bounds);
+    // Applies the changes made since the last call, by refit or rebuild
+    void Refresh();
+
+    // Subtrees fully inside the frustum or box are added without testing their items
+    void QueryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& ids) const;
+    void QueryBounds(const Bounds& bounds, std::vector<std::uint32_t>& ids) const;
+    void QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& ids) const;
+    const bool Raycast(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, RayHit& hit) const;
+
+    inline const std::uint32_t GetCount() const { return mCount; }
+    inline const Bounds GetBounds(const std::uint32_t id) const { return id < mItems.size() ? mItems[id] : Bounds(); }
+    inline const size_t GetNodeCount() const { return mNodes.size(); }
+};
+
+} // namespace Graphic
+} // namespace Vision
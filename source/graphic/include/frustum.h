@@ -0,0 +1,81 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief The six planes of a view-projection matrix, normals pointing inside.
+ */
+class Frustum
+{
+public:
+    enum class eOverlap
+    {
+        OUTSIDE,
+        PARTIAL,    // Crosses a plane, or near a corner outside
+        INSIDE
+    };
+
+private:
+    using Vector4 = System::Types::Vector4;
+
+    Vector4 mPlanes[6];     // xyz normal, w distance; inside where dot(normal, p) + w >= 0
+
+public:
+    // Planes of the clip volume of the matrix, in the space the matrix transforms from
+    explicit Frustum(const System::Types::Matrix44& viewProjection);
+
+    // Outside only if the box is fully outside one of the planes, so boxes near corners may pass
+    const eOverlap Classify(const Bounds& bounds) const;
+    inline const bool Intersects(const Bounds& bounds) const { return Classify(bounds) != eOverlap::OUTSIDE; }
+    inline const Vector4& GetPlane(const int index) const { return mPlanes[index]; }
+};
+
+/**
+ * @brief Culls many boxes against a frustum, in SoA batches of sBatchSize.
+ *
+ * Boxes are kept as centers and extents, one array per axis, and tested 8 at a time with AVX
+ * (two halves with SSE2, one by one otherwise). Batches are split across the JobPool and the
+ * ids of the visible boxes are returned in slot order.
+ */
+class FrustumCuller
+{
+public:
+    static const size_t sBatchSize = 8;
+
+private:
+    static const size_t sBatchesPerJob = 128;
+
+    std::vector<float> mCenters[3];
+    std::vector<float> mExtents[3];
+    std::vector<std::uint32_t> mIds;
+    std::vector<std::vector<std::uint32_t>> mJobVisible;   // Visible ids of every job, merged after
+    std::vector<std::uint32_t> mVisible;
+
+    void CullBatches(const Frustum& frustum, const size_t firstBatch, const size_t lastBatch, std::vector<std::uint32_t>& visible) const;
+
+public:
+    // Boxes are set by slot, so several threads can fill them
+    void Resize(const size_t count);
+    // Empty boxes are never visible
+    void Set(const size_t slot, const Bounds& bounds, const std::uint32_t id);
+
+    /**
+     * @brief Tests every box.
+     *
+     * @return Ids of the boxes intersecting the frustum, valid until the next Cull.
+     */
+    const std::vector<std::uint32_t>& Cull(const Frustum& frustum);
+
+    inline const size_t GetCount() const { return mIds.size(); }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <graphic/include/bounds.h>
+#include <graphic/include/textureCook.h>
 #include <system/include/moduleOpenGL.h>
 #include <system/include/types.h>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 namespace Vision
 {
@@ -10,8 +15,35 @@ namespace Graphic
 {
 
 using TextureInfo = System::Types::TextureInfo;
-using TextureMap = std::map<std::string, TextureInfo>;  // Ordered set of texture names/info
+using TextureMap = std::map<std::string, std::unique_ptr<TextureInfo>>;  // Ordered set of texture names/info
+using TextureAliasMap = std::map<std::string, std::string>;              // Canonical file path -> texture name
+using TextureHashMap = std::unordered_map<std::uint64_t, std::string>;   // Decoded content hash -> texture name
+
+/**
+ * @brief Where a texture was packed inside an atlas page.
+ *
+ * A texture coordinate of the source texture maps to uvOffset + uv * uvScale in the page.
+ */
+struct AtlasRegion
+{
+    std::string page;   // Texture name of the atlas page
+    System::Types::Vector2 uvOffset = System::Types::Vector2(0.0f);
+    System::Types::Vector2 uvScale = System::Types::Vector2(1.0f);
+};
 
+using AtlasMap = std::map<std::string, AtlasRegion>;    // Source texture name -> region in an atlas page
+
+/**
+ * @brief Singleton owning every texture in use.
+ *
+ * Textures are deduplicated, first by canonical file path and then by the hash of the decoded
+ * pixels, so every user of the same image shares one TextureInfo and one GL texture. New
+ * textures are cooked into their mip chain as they are added, or read cooked from .vtex files.
+ * Images cooked from a file are saved next to it, named by their pixels and the cook settings,
+ * and read back instead of cooked again on later runs. Each
+ * AddTexture/RetainTexture must be paired with a ReleaseTexture; the texture is destroyed
+ * when its last reference is released.
+ */
 class TextureLoader
 {
 private:
@@ -19,19 +51,51 @@ private:
     TextureLoader();
 
     TextureMap mTextureList;
+    TextureAliasMap mPathList;
+    TextureHashMap mHashList;
+    AtlasMap mAtlasList;
+    TextureCook::Settings mCookSettings;
 
-    static TextureLoader* mInstance;
+    // Built on first use, textures may be added by static initializers of other files
+    static TextureLoader& Get();
 
     static TextureInfo& iAddTexture(const char* path, const char* name = "unnamed");
+    static TextureInfo& iAddTexture(std::unique_ptr<TextureInfo> texture, const char* name = "unnamed");
+    static void iRetainTexture(TextureInfo& texture);
+    static const bool iReleaseTexture(TextureInfo& texture);
     static const bool iRemoveTexture(const char* name);
     static const GLuint iGetTexture(const char* name);
     static TextureMap& iGetTextureList();
+    static TextureInfo* iFindTexture(const char* name);
+    static void iSetAtlasRegion(const char* name, const AtlasRegion& region);
+    static const AtlasRegion* iFindAtlasRegion(const char* name);
+
+    static TextureInfo& Register(std::unique_ptr<TextureInfo> texture, const std::string& canonical, const char* name);
+    static const std::string CanonicalPath(const char* path);
+    static const std::uint64_t ContentHash(const TextureInfo& texture);
+    // Reads the cooked chain of an image file saved by a previous run, or cooks and saves it
+    static void Cook(TextureInfo& texture, const std::string& canonical);
+    static const std::string CookedPath(const std::string& canonical, const std::uint64_t contentHash, const TextureCook::Settings& settings);
+    void Destroy(TextureMap::iterator entry);
 
 public:
     static inline TextureInfo& AddTexture(const char* path, const char* name = "unnamed")
     {
         return iAddTexture(path, name);
     }
+    // Takes ownership of a texture built in memory, deduplicated by content like file textures
+    static inline TextureInfo& AddTexture(std::unique_ptr<TextureInfo> texture, const char* name = "unnamed")
+    {
+        return iAddTexture(std::move(texture), name);
+    }
+    static inline void RetainTexture(TextureInfo& texture)
+    {
+        iRetainTexture(texture);
+    }
+    static inline const bool ReleaseTexture(TextureInfo& texture)
+    {
+        return iReleaseTexture(texture);
+    }
     static inline const bool RemoveTexture(const char* name)
     {
         return iRemoveTexture(name);
@@ -44,6 +108,30 @@ public:
     {
         return iGetTextureList();
     }
+    static inline TextureInfo* FindTexture(const char* name)
+    {
+        return iFindTexture(name);
+    }
+    // Records that the texture was packed into an atlas page
+    static inline void SetAtlasRegion(const char* name, const AtlasRegion& region)
+    {
+        iSetAtlasRegion(name, region);
+    }
+    static inline const AtlasRegion* FindAtlasRegion(const char* name)
+    {
+        return iFindAtlasRegion(name);
+    }
+    // Dynamic textures keep mutable storage, to be respecified later. Must be set before the upload
+    static inline void SetUsage(TextureInfo& texture, const System::Types::eUsage usage)
+    {
+        assert(!texture.IsUploaded());
+        texture.usage = usage;
+    }
+    // Settings used to cook the mip chain of textures added from now on
+    static inline void SetCookSettings(const TextureCook::Settings& settings)
+    {
+        Get().mCookSettings = settings;
+    }
 };
 
 class GraphicData
@@ -53,35 +141,60 @@ class GraphicData
     using TextureVector = std::vector<System::Types::TextureInfo*>;
     using Matrix = System::Types::Matrix44;
 
+    static std::atomic<std::uint64_t> mNextVersion;
+
     GLenum mDrawMode = GL_TRIANGLES;
 
     VertexVector mVertices;
     IndexVector mIndices;
     TextureVector mTextures;
     Matrix mMatrixTransform;
+    std::uint64_t mVersion;     // Identifies the geometry, renewed on every change and shared only by copies
+    mutable Bounds mBounds;                 // Of the vertex positions, in model space
+    mutable std::uint64_t mBoundsVersion;   // Version mBounds was computed for, 0 if never
+
+    inline void Touch() { mVersion = ++mNextVersion; }
 
 public:
     GraphicData();
     GraphicData(std::initializer_list<GLfloat> vertices, std::initializer_list<GLuint> indices, std::initializer_list<const char*> texturePaths = {});
+    GraphicData(const GraphicData& other);
+    GraphicData& operator=(const GraphicData& other);
     ~GraphicData();
 
     void AddVertex(std::initializer_list<System::Types::Float> vertex);
     void AddIndex(std::initializer_list<System::Types::UInt> index);
     void AddTexture(const char* texturePaths);
 
-    void SetBuffers(GLuint& vertexBuffer, GLuint& elementBuffer) const;
-
-    inline VertexVector& GetVertexArray() { return mVertices; }
+    // Binds every texture to the unit of its position
+    void BindTextures() const;
+    // True if both bind the same GL textures, so they can be drawn by one command
+    const bool HasSameTextures(const GraphicData& other) const;
+    // Identifies the bound textures for sorting, equal for data with the same textures
+    const std::uint32_t GetMaterialID() const;
+    const bool ApplyAtlas();
+
+    // Geometry may be changed through the returned reference, so it is uploaded again on next use
+    inline VertexVector& GetVertexArray() { Touch(); return mVertices; }
+    inline const VertexVector& GetVertices() const { return mVertices; }
+    inline const IndexVector& GetIndices() const { return mIndices; }
+    inline const std::uint64_t GetVersion() const { return mVersion; }
+    inline const size_t GetVertexCount() const { return mVertices.size() / System::Types::VertexConst::SIZE; }
     inline const size_t GetIndexCount() const { return mIndices.size(); }
+    // Box of the vertex positions in model space, computed again after the geometry changes
+    const Bounds& GetBounds() const;
+    inline const Bounds GetWorldBounds() const { return GetBounds().Transformed(mMatrixTransform); }
 
-    inline const Matrix& GetModel() { return mMatrixTransform; }
+    // The model matrix is sent per draw, changing it doesn't upload the geometry again
+    inline const Matrix& GetModel() const { return mMatrixTransform; }
+    inline void SetModel(const Matrix& model) { mMatrixTransform = model; }
     inline void RotateModel(const System::Types::Float angle, const System::Types::Vector3 axis)
     {
-        glm::rotate(mMatrixTransform, angle, axis);
+        mMatrixTransform = glm::rotate(mMatrixTransform, angle, axis);
     }
     inline void TranslateModel(const System::Types::Vector3 position)
     {
-        glm::translate(mMatrixTransform, position);
+        mMatrixTransform = glm::translate(mMatrixTransform, position);
     }
 };
 
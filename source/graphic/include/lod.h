@@ -0,0 +1,74 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <system/include/types.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Picks levels of detail from the error they would show on screen.
+ *
+ * Every level of a chain has a geometric error, how far in world units its surface may stray
+ * from the full mesh; level 0 is the full mesh, without error. Projected at the distance of the
+ * object bounds the error is in pixels, and the coarsest level under the threshold is wanted.
+ * A coarser level is only taken once it is under the threshold by the hysteresis margin, and
+ * the current one is only left for a finer one once it is over it by the margin, so objects
+ * near a boundary don't switch back and forth. Switches may cross fade over a few frames, both
+ * levels being drawn with complementary dither patterns meanwhile.
+ */
+class LodSelector
+{
+public:
+    struct Settings
+    {
+        float pixelError = 1.0f;        // Projected error allowed, in pixels
+        float qualityBias = 1.0f;       // Scales the allowed error, above 1 picks coarser levels everywhere
+        float hysteresis = 0.25f;       // Margin around the threshold to switch levels, relative to it
+        float viewportHeight = 600.0f;  // Pixels the projection spans vertically
+        std::uint32_t fadeFrames = 0;   // Frames a switch cross fades over, 0 switches at once
+    };
+
+    // Selection of one object, kept from frame to frame
+    struct State
+    {
+        std::uint8_t level = 0;
+        std::uint8_t previous = 0;      // Level fading out, the current one when not fading
+        std::uint32_t fadeFrame = 0;    // Frames since the switch
+    };
+
+private:
+    Settings mSettings;
+    System::Types::Vector3 mCameraPosition;
+    float mPixelsPerUnit;               // Pixels covered by one world unit at distance 1
+
+    // Error in pixels of a level at the given distance
+    inline const float Project(const float error, const float distance) const { return error * mPixelsPerUnit / distance; }
+
+public:
+    LodSelector();
+
+    // Camera of the frame, before selecting
+    void Begin(const System::Types::Vector3& cameraPosition, const System::Types::Matrix44& projection);
+
+    /**
+     * @brief Updates the level of an object for this frame.
+     *
+     * @param[in] errors Geometric error of every level, from the finest; the first is 0.
+     */
+    void Select(State& state, const Bounds& bounds, const float* errors, const size_t levelCount) const;
+
+    // Coverage of the current level, in (0, 1]; the previous level covers the rest while fading
+    const float GetFade(const State& state) const;
+    inline const bool IsFading(const State& state) const { return state.previous != state.level; }
+
+    inline void SetSettings(const Settings& settings) { mSettings = settings; }
+    inline const Settings& GetSettings() const { return mSettings; }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <core/include/offsetAllocator.h>
+#include <graphic/include/graphic.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Scene-wide vertex and index storage, sub-allocated per mesh.
+ *
+ * Every mesh gets its own range of a shared vertex buffer and a shared element buffer, so a
+ * whole scene is drawn from one VAO with glDrawElementsBaseVertex. Ranges are managed by a
+ * Core::OffsetAllocator per buffer and can be released, buffers grow by copying their contents
+ * on the GL side. Defragment moves ranges towards the start of the buffers, a little per call;
+ * meshes are referred to by handle so their ranges can move under them.
+ */
+class MeshArena
+{
+public:
+    /**
+     * @brief Reference to a mesh of the arena. Handles of released meshes or of a cleared arena are void.
+     */
+    struct Handle
+    {
+        std::uint32_t index = 0xFFFFFFFF;
+        std::uint32_t generation = 0;
+    };
+
+    /**
+     * @brief Place of one mesh inside the arena, in vertices and indices.
+     */
+    struct Range
+    {
+        System::Types::UInt firstVertex = 0;
+        System::Types::UInt vertexCount = 0;
+        System::Types::UInt firstIndex = 0;
+        System::Types::UInt indexCount = 0;
+    };
+
+    struct Report
+    {
+        Core::OffsetAllocator::Report vertices;     // In vertices
+        Core::OffsetAllocator::Report indices;      // In indices
+        size_t meshCount = 0;
+    };
+
+private:
+    using Allocation = Core::OffsetAllocator::Allocation;
+
+    struct Pool
+    {
+        GLuint buffer = 0;
+        size_t elementBytes = 0;
+        Core::OffsetAllocator allocator;
+        std::unordered_map<std::uint32_t, std::uint32_t> owners;   // Allocator node -> entry index
+    };
+
+    struct Entry
+    {
+        Range range;
+        Allocation vertices;
+        Allocation indices;
+        std::uint64_t version = 0;      // GraphicData version held by the ranges, 0 if nothing was uploaded
+        std::uint32_t generation = 1;   // Bumped on release, so old handles stop matching
+        bool alive = false;
+    };
+
+    std::vector<Entry> mEntries;
+    std::vector<std::uint32_t> mFreeEntries;
+
+    Pool mVertices;
+    Pool mIndices;
+
+    const Allocation Allocate(Pool& pool, const std::uint32_t elements, const std::uint32_t entry);
+    void Free(Pool& pool, const Allocation& allocation);
+    void Resize(Pool& pool, const std::uint32_t elements);
+    void Write(const Pool& pool, const std::uint32_t first, const void* data, const std::uint32_t count);
+    const size_t Compact(Pool& pool, const size_t maxBytes);
+    void SetOffset(const Pool& pool, const std::uint32_t entryIndex, const Allocation& allocation);
+    const bool IsValid(const Handle& handle) const;
+
+public:
+    MeshArena();
+
+    /**
+     * @brief Sets the GL buffers to sub-allocate. Changing them releases every mesh.
+     */
+    void SetBuffers(const GLuint vertexBuffer, const GLuint elementBuffer);
+
+    /**
+     * @brief Makes the arena hold the current geometry of a mesh.
+     *
+     * The mesh is allocated on first use or when its size changed, and uploaded only when its
+     * ranges don't hold its current version yet.
+     *
+     * @param[in] data The mesh.
+     * @param[in,out] handle The mesh in the arena, default constructed the first time.
+     * @return True if the geometry was uploaded.
+     */
+    const bool Store(const GraphicData& data, Handle& handle);
+
+    /**
+     * @brief Returns the ranges of a mesh to the free space and voids its handle.
+     */
+    void Release(Handle& handle);
+
+    /**
+     * @brief Current place of a mesh, empty for void handles.
+     */
+    const Range GetRange(const Handle& handle) const;
+
+    /**
+     * @brief Moves meshes from the end of the buffers into free space closer to the start.
+     *
+     * The last mesh goes into a free range before it when one fits, otherwise the first mesh
+     * after a free range slides down over it. Ranges are copied with glCopyBufferSubData and
+     * patched in place; already stored handles see the new offsets. Meant to run once per frame
+     * with a small budget.
+     *
+     * @param[in] maxBytes Bytes to move at most, per buffer.
+     * @return Bytes moved.
+     */
+    const size_t Defragment(const size_t maxBytes);
+
+    /**
+     * @brief Releases every mesh, the buffers are kept.
+     */
+    void Clear();
+
+    const Report GetReport() const;
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <system/include/types.h>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace Mipmap
+{
+
+enum class eFilter
+{
+    BOX,        // Average of the covered texels, cheapest and blurriest
+    KAISER,     // Kaiser windowed sinc, sharp with little ringing
+    LANCZOS     // Lanczos-3 windowed sinc, sharpest
+};
+
+struct Settings
+{
+    eFilter filter = eFilter::KAISER;
+    bool gammaCorrect = true;   // Filter the color channels in linear space, alpha is always linear
+    bool wrap = true;           // Wrap around the edges like GL_REPEAT, clamp otherwise
+};
+
+using LevelVector = std::vector<System::Types::TextureLevel>;
+
+/**
+ * @brief Number of levels of a full mip chain for an image of the given size.
+ */
+const int LevelCount(const int width, const int height);
+
+/**
+ * @brief Builds the full mip chain of an RGBA image on the CPU.
+ *
+ * Each level is filtered from the previous one, kept in linear float precision between levels.
+ * Rows of every level are split in tiles across the Core::JobPool.
+ *
+ * @param[in] rgba The base image, 4 bytes per pixel, tightly packed.
+ * @param[in] width Width of the base image in pixels.
+ * @param[in] height Height of the base image in pixels.
+ * @param[in] settings Filter and color space options.
+ * @return Every level, the base image first and the 1x1 level last.
+ */
+LevelVector GenerateChain(const unsigned char* rgba, const int width, const int height, const Settings& settings = Settings());
+
+} // namespace Mipmap
+} // namespace Graphic
+} // namespace Vision
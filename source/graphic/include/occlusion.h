@@ -0,0 +1,77 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Occlusion culling against occluders rasterized in software to a small depth buffer.
+ *
+ * Occluder triangles are projected, clipped to the near plane and binned into screen tiles.
+ * Every tile is then rasterized by its own job, 8 pixels at a time with AVX (two halves with
+ * SSE2, one by one otherwise), keeping the nearest depth. A hierarchical Z pyramid holding the
+ * farthest depth of every 2x2 block is built on top, and boxes are tested on the level where
+ * their screen rectangle covers at most 2x2 texels. Depths are NDC z mapped to [0, 1].
+ */
+class OcclusionCuller
+{
+public:
+    static const int sWidth = 256;
+    static const int sHeight = 128;
+
+private:
+    using Vector4 = System::Types::Vector4;
+
+    static const int sTileWidth = 32;
+    static const int sTileHeight = 16;
+    static const int sTilesX = sWidth / sTileWidth;
+    static const int sTilesY = sHeight / sTileHeight;
+    static const int sLevelCount = 8;       // Down to 2x1 texels
+
+    // Set up in screen space, sampled at pixel centers
+    struct Triangle
+    {
+        float edges[3][3];          // a, b, c of the edge functions a * x + b * y + c, positive inside
+        float depth[3];             // a, b, c of the depth plane
+        int minX, minY, maxX, maxY; // Pixels it may cover, inside the screen
+    };
+
+    System::Types::Matrix44 mViewProjection;
+    std::vector<Triangle> mTriangles;
+    std::vector<std::uint32_t> mBins[sTilesX * sTilesY];   // Triangles overlapping every tile
+    std::vector<float> mLevels[sLevelCount];                // Level 0 is the depth buffer
+
+    // Clips a triangle in clip space to the near plane and sets up what is left
+    void AddTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+    void SetupTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+    void RasterizeTile(const int tile);
+    // 8-pixel spans of a row from minX, given the edge functions and depth at x = 0; only run where Simd::HasAVX
+    static void RasterizeRowAVX(const Triangle& triangle, const float edges[3], const float plane, float* row, const int minX, const int maxX);
+    void BuildPyramid();
+
+public:
+    OcclusionCuller();
+
+    // Clears the depth buffer and the occluders, for a new view
+    void Begin(const System::Types::Matrix44& viewProjection);
+    // Adds the triangles of a mesh laid out like GraphicData, in world space through the model matrix
+    void AddOccluder(const System::Types::VertexVector& vertices, const System::Types::IndexVector& indices, const System::Types::Matrix44& model);
+    // Rasterizes the occluders added since Begin and builds the pyramid
+    void Rasterize();
+
+    // False if the box is behind the occluders over its whole screen rectangle, or off screen
+    const bool IsVisible(const Bounds& bounds) const;
+
+    inline const size_t GetTriangleCount() const { return mTriangles.size(); }
+    // Nearest depth of every pixel, row by row from the bottom of the screen
+    inline const std::vector<float>& GetDepth() const { return mLevels[0]; }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <system/include/types.h>
+#include <cstddef>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace Pixel
+{
+
+/**
+ * @brief How a decoded image has to be handed to glTexImage2D.
+ */
+struct UploadFormat
+{
+    GLenum internalFormat = GL_RGBA8;
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLint alignment = 4;        // GL_UNPACK_ALIGNMENT for the rows of the uploaded data
+    int channels = 4;           // Channels of the uploaded data, differs from the source when it needs expanding
+    bool swizzle = false;       // Whether swizzleMask must be applied to the texture
+    GLint swizzleMask[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+};
+
+/**
+ * @brief Picks the internal format, pixel layout and row alignment for an image.
+ *
+ * RGB images are expanded to RGBA so rows are always 4-byte aligned, gray and gray+alpha images
+ * stay single/dual channel and are swizzled to RGB(A) by the sampler.
+ *
+ * @param[in] nrChannels Channels of the decoded image (1 to 4).
+ * @param[in] width Width of the image in pixels.
+ * @param[in] srgb Whether the color channels are sRGB encoded.
+ * @return The upload format to use.
+ */
+const UploadFormat ChooseUploadFormat(const int nrChannels, const int width, const bool srgb = false);
+
+/**
+ * @brief Expands tightly packed RGB pixels to RGBA with a constant alpha.
+ */
+void ExpandRGBToRGBA(const unsigned char* src, unsigned char* dst, const size_t pixelCount, const unsigned char alpha = 255);
+
+/**
+ * @brief Expands gray pixels to RGB by replicating the gray value.
+ */
+void ExpandGrayToRGB(const unsigned char* src, unsigned char* dst, const size_t pixelCount);
+
+/**
+ * @brief Converts 1 to 4 channel pixels to RGBA. Gray is replicated, missing alpha is opaque.
+ */
+void ConvertToRGBA(const unsigned char* src, const int nrChannels, unsigned char* dst, const size_t pixelCount);
+
+/**
+ * @brief Decodes 8-bit sRGB values to linear floats in [0, 1].
+ */
+void SRGBToLinear(const unsigned char* src, float* dst, const size_t count);
+
+/**
+ * @brief Encodes linear floats to 8-bit sRGB values. Input is clamped to [0, 1].
+ */
+void LinearToSRGB(const float* src, unsigned char* dst, const size_t count);
+
+/**
+ * @brief Multiplies the color channels of RGBA pixels by their alpha, in place.
+ */
+void PremultiplyAlpha(unsigned char* rgba, const size_t pixelCount);
+
+/**
+ * @brief Flips an image upside down, in place.
+ *
+ * @param[in,out] data The image rows, tightly packed.
+ * @param[in] width Width of the image in pixels.
+ * @param[in] height Height of the image in pixels.
+ * @param[in] bytesPerPixel Size of one pixel in bytes.
+ */
+void FlipVertical(unsigned char* data, const int width, const int height, const int bytesPerPixel);
+
+} // namespace Pixel
+} // namespace Graphic
+} // namespace Vision
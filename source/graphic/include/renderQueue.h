@@ -0,0 +1,71 @@
+#pragma once
+
+#include <system/include/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Per-frame list of draws, ordered by packed 64-bit sort keys.
+ *
+ * Opaque keys, from the highest bits: pass (2), program (8), material (24), depth (24); draws
+ * sharing state end up together and go front to back inside each group. Transparent keys put
+ * the inverted depth right after the pass so they go back to front whatever their state.
+ * Keys are radix sorted; equal keys keep the order they were added in, so the order is
+ * deterministic.
+ */
+class RenderQueue
+{
+public:
+    enum class ePass : std::uint32_t
+    {
+        OPAQUE_PASS = 0,
+        TRANSPARENT_PASS = 1
+    };
+
+    struct Item
+    {
+        std::uint64_t key = 0;
+        std::uint32_t index = 0;    // Caller's draw, returned in sorted order
+    };
+
+private:
+    std::vector<Item> mItems;
+    std::vector<Item> mScratch;
+
+public:
+    static const std::uint32_t sProgramBits = 8;
+    static const std::uint32_t sMaterialBits = 24;
+    static const std::uint32_t sDepthBits = 24;
+
+    /**
+     * @brief Packs a sort key.
+     *
+     * @param[in] pass Opaque or transparent, opaque draws come first.
+     * @param[in] program Program of the draw, only the low sProgramBits are kept.
+     * @param[in] material Textures and other state of the draw, only the low sMaterialBits are kept.
+     * @param[in] depth View space distance to the camera, negative values count as 0.
+     */
+    static const std::uint64_t MakeKey(const ePass pass, const std::uint32_t program, const std::uint32_t material, const float depth);
+    static const ePass GetPass(const std::uint64_t key);
+
+    inline void Clear() { mItems.clear(); }
+    inline void Add(const std::uint64_t key, const std::uint32_t index) { mItems.push_back({ key, index }); }
+
+    /**
+     * @brief Sorts the draws by key, LSD radix sort of 8 bits per pass.
+     *
+     * Passes over a byte that is the same in every key are skipped.
+     */
+    void Sort();
+
+    inline const std::vector<Item>& GetItems() const { return mItems; }
+    inline const size_t GetSize() const { return mItems.size(); }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <system/include/moduleOpenGL.h>
+#include <system/include/programRegistry.h>
 
 
 namespace Vision
@@ -11,17 +12,23 @@ namespace Graphic
 static const char* sDefaultVShaderPath = "shaders\\default_vs.glsl";
 static const char* sDefaultFShaderPath = "shaders\\default_fs.glsl";
 
+// Program of the ProgramRegistry, shared with every other user of the same files
 class Shader
 {
 protected:
-	System::Types::UInt mId;
+	System::Types::UInt mId;    // Program, or program pipeline when System::ProgramRegistry::IsSeparable
 	std::vector<System::Types::UInt> mBuffers;
+	System::ProgramRegistry::Entry* mProgram;
 
 	void Initialize(const char* vertexPath, const char* fragmentPath);
 
 public:
 	Shader();
 	Shader(const char* vertexPath, const char* fragmentPath);
+	~Shader();
+
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
 
 	GETSET_MEMBER(System::Types::UInt, Id);
 };
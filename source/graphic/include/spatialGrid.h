@@ -0,0 +1,86 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <graphic/include/frustum.h>
+#include <graphic/include/spatialIndex.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Loose uniform grid over the bounds of items with dense ids, hashed by cell.
+ *
+ * Items live in the cell of their center, and a cell is queried by its box grown by half a
+ * cell on every side, which holds any item no bigger than a cell. Bigger items are kept aside
+ * and tested one by one. Inserting, removing and moving an item are constant time and applied
+ * immediately, an item moving within its cell doesn't touch the cell at all. Refresh has
+ * nothing to do. Queries return ids in no particular order.
+ */
+class SpatialGrid : public ISpatialIndex
+{
+    // Cell coordinates are packed in 21 bits per axis
+    static const std::int32_t sCellRange = 1 << 20;
+
+    struct Cell
+    {
+        Bounds bounds;                  // Loose bounds, holding every item of the cell
+        std::uint64_t key = 0;
+        std::vector<std::uint32_t> items;
+    };
+
+    struct Item
+    {
+        Bounds bounds;                  // Empty if the id isn't in the grid
+        std::uint64_t key = 0;          // Of its cell, unused when oversized
+        std::uint32_t cell = 0;         // Index of its cell in mCells
+        std::uint32_t slot = 0;         // Index in the items of its cell, or in mOversized
+        bool oversized = false;
+    };
+
+    float mCellSize;
+    std::vector<Cell> mCells;           // Occupied cells, kept dense so queries walk them in order
+    std::unordered_map<std::uint64_t, std::uint32_t> mCellIndices;
+    std::vector<Item> mItems;
+    std::vector<std::uint32_t> mOversized;  // Items bigger than a cell
+    std::uint32_t mCount;
+
+    const glm::ivec3 GetCoords(const System::Types::Vector3& point) const;
+    const std::uint64_t GetKey(const glm::ivec3& coords) const;
+    const Bounds GetLooseBounds(const glm::ivec3& coords) const;
+    void Place(const std::uint32_t id);
+    void Unplace(const std::uint32_t id);
+    // Calls visit(cell) for the cells that may hold items overlapping the box
+    template <typename Visitor>
+    void VisitCells(const Bounds& bounds, const Visitor& visit) const;
+
+public:
+    // Items up to the cell size fit a cell. Cells holding a handful of items each are the sweet spot: smaller
+    // ones are crossed more often and make frustum queries walk more cells
+    SpatialGrid(const float cellSize = 16.0f);
+
+    void Clear();
+    void Insert(const std::uint32_t id, const Bounds& bounds);
+    void Remove(const std::uint32_t id);
+    void Move(const std::uint32_t id, const Bounds& bounds);
+    void Refresh();
+
+    // Cells fully inside the frustum or box are added without testing their items
+    void QueryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& ids) const;
+    void QueryBounds(const Bounds& bounds, std::vector<std::uint32_t>& ids) const;
+    void QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& ids) const;
+    const bool Raycast(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, RayHit& hit) const;
+
+    inline const std::uint32_t GetCount() const { return mCount; }
+    inline const Bounds GetBounds(const std::uint32_t id) const { return id < mItems.size() ? mItems[id].bounds : Bounds(); }
+    inline const size_t GetCellCount() const { return mCells.size(); }
+    inline const float GetCellSize() const { return mCellSize; }
+};
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <graphic/include/bounds.h>
+#include <graphic/include/frustum.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+/**
+ * @brief Queries over the bounds of items with dense ids, shared by every spatial structure.
+ *
+ * Queries test item bounds only and append the ids they find. Changes are visible to queries
+ * once Refresh is called; structures may apply them earlier.
+ */
+class ISpatialIndex
+{
+public:
+    struct RayHit
+    {
+        std::uint32_t id = 0;
+        float distance = 0.0f;      // Along the ray to the entry point of the item bounds, 0 if it starts inside
+    };
+
+    virtual ~ISpatialIndex() {}
+
+    virtual void Clear() = 0;
+    // An id in the index already is moved instead
+    virtual void Insert(const std::uint32_t id, const Bounds& bounds) = 0;
+    virtual void Remove(const std::uint32_t id) = 0;
+    virtual void Move(const std::uint32_t id, const Bounds& bounds) = 0;
+    virtual void Refresh() = 0;
+
+    virtual void QueryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& ids) const = 0;
+    virtual void QueryBounds(const Bounds& bounds, std::vector<std::uint32_t>& ids) const = 0;
+    virtual void QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& ids) const = 0;
+
+    /**
+     * @brief Finds the item whose bounds the ray enters first.
+     *
+     * @param[in] direction Direction of the ray, distances are in its length.
+     * @return False if no bounds are hit closer than maxDistance.
+     */
+    virtual const bool Raycast(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, RayHit& hit) const = 0;
+
+    virtual const std::uint32_t GetCount() const = 0;
+    // Empty for ids not in the index
+    virtual const Bounds GetBounds(const std::uint32_t id) const = 0;
+};
+
+enum class eSpatialStructure
+{
+    BVH,    // Fast queries, cheap refits for few moving items; for static objects
+    GRID    // Constant time updates, for objects that move every frame
+};
+
+std::unique_ptr<ISpatialIndex> CreateSpatialIndex(const eSpatialStructure structure);
+
+} // namespace Graphic
+} // namespace Vision
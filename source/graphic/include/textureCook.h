@@ -0,0 +1,67 @@
+#pragma once
+
+#include <graphic/include/mipmap.h>
+#include <system/include/types.h>
+#include <cstdint>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace TextureCook
+{
+
+static const char* sCookedExtension = ".vtex";
+static const char* sCookedDirectory = "cooked";     // Next to the source images, cooked once and read back on later runs
+
+enum class eCompression
+{
+    NONE,   // Keep the levels as RGBA8
+    AUTO,   // BC1 for opaque textures, BC7 for the rest
+    BC1,
+    BC3,
+    BC7
+};
+
+struct Settings
+{
+    bool generateMips = true;
+    eCompression compression = eCompression::AUTO;
+    double minPSNR = 24.0;      // Base levels compressed below this quality, in dB, are kept as RGBA8
+    Mipmap::Settings mips;
+};
+
+/**
+ * @brief Turns the decoded pixels of a texture into its upload-ready mip chain.
+ *
+ * Pixels are converted to RGBA and filtered into texture.levels, the decoded data is released.
+ * RGBA levels, freshly built or already cooked, are then block compressed as requested.
+ * Does nothing on compressed textures or textures without data.
+ *
+ * @param[in,out] texture The texture to cook.
+ * @param[in] settings Mip chain and compression options.
+ */
+void Cook(System::Types::TextureInfo& texture, const Settings& settings = Settings());
+
+/**
+ * @brief Writes the levels of a cooked texture to a .vtex file.
+ *
+ * @return True if the file was written.
+ */
+const bool Save(const System::Types::TextureInfo& texture, const char* path);
+
+/**
+ * @brief Reads the levels of a texture from a .vtex file.
+ *
+ * @return True if the file was read and is valid, texture is left untouched otherwise.
+ */
+const bool Load(System::Types::TextureInfo& texture, const char* path);
+
+/**
+ * @brief Whether a path names a cooked texture file.
+ */
+const bool IsCookedPath(const char* path);
+
+} // namespace TextureCook
+} // namespace Graphic
+} // namespace Vision
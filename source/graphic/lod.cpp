@@ -0,0 +1,85 @@
+#include <graphic/include/lod.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//********************************
+//     Class LodSelector
+//********************************
+//----------------------------------------------------------------
+LodSelector::LodSelector()
+    : mSettings()
+    , mCameraPosition(0.0f)
+    , mPixelsPerUnit(0.0f)
+{}
+
+//----------------------------------------------------------------
+void LodSelector::Begin(const System::Types::Vector3& cameraPosition, const System::Types::Matrix44& projection)
+{
+    // projection[1][1] is the cotangent of half the vertical field of view
+    mCameraPosition = cameraPosition;
+    mPixelsPerUnit = projection[1][1] * mSettings.viewportHeight * 0.5f;
+}
+
+//----------------------------------------------------------------
+void LodSelector::Select(State& state, const Bounds& bounds, const float* errors, const size_t levelCount) const
+{
+    if (IsFading(state) && ++state.fadeFrame >= mSettings.fadeFrames)
+    {
+        state.previous = state.level;
+    }
+    if (levelCount <= 1 || bounds.IsEmpty())
+    {
+        return;
+    }
+
+    // Inside the bounds the error has no bound, the full mesh is kept
+    const float distance = std::sqrt(bounds.GetSquaredDistance(mCameraPosition));
+    const float threshold = mSettings.pixelError * mSettings.qualityBias;
+    size_t current = std::min<size_t>(state.level, levelCount - 1);
+    size_t level = current;
+    if (distance <= 0.0f || Project(errors[current], distance) > threshold * (1.0f + mSettings.hysteresis))
+    {
+        // Finest level needed, down to the full mesh
+        while (level > 0 && (distance <= 0.0f || Project(errors[level], distance) > threshold))
+        {
+            --level;
+        }
+    }
+    else
+    {
+        // Coarsest level clearly under the threshold, or stay
+        for (size_t coarser = current + 1; coarser < levelCount; ++coarser)
+        {
+            if (Project(errors[coarser], distance) <= threshold * (1.0f - mSettings.hysteresis))
+            {
+                level = coarser;
+            }
+        }
+    }
+
+    if (level != current)
+    {
+        state.previous = mSettings.fadeFrames > 0 ? static_cast<std::uint8_t>(current) : static_cast<std::uint8_t>(level);
+        state.level = static_cast<std::uint8_t>(level);
+        state.fadeFrame = 0;
+    }
+}
+
+//----------------------------------------------------------------
+const float LodSelector::GetFade(const State& state) const
+{
+    if (!IsFading(state) || mSettings.fadeFrames == 0)
+    {
+        return 1.0f;
+    }
+    return static_cast<float>(state.fadeFrame + 1) / static_cast<float>(mSettings.fadeFrames + 1);
+}
+
+} // namespace Graphic
+} // namespace Vision
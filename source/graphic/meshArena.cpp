@@ -0,0 +1,321 @@
+#include <graphic/include/meshArena.h>
+
+#include <system/include/frameStats.h>
+#include <system/include/glState.h>
+#include <system/include/moduleOpenGL.h>
+#include <algorithm>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+namespace
+{
+    static const std::uint32_t sMinimumCapacity = 1024;    // Elements allocated on first use of a pool
+} // namespace
+
+//********************************
+//     Class MeshArena
+//********************************
+//----------------------------------------------------------------
+MeshArena::MeshArena()
+    : mEntries()
+    , mFreeEntries()
+    , mVertices()
+    , mIndices()
+{
+    mVertices.elementBytes = System::Types::VertexConst::sStrideSize;
+    mIndices.elementBytes = System::Types::VertexConst::sIndexElementBytes;
+}
+
+//----------------------------------------------------------------
+void MeshArena::SetBuffers(const GLuint vertexBuffer, const GLuint elementBuffer)
+{
+    if (mVertices.buffer == vertexBuffer && mIndices.buffer == elementBuffer)
+    {
+        return;
+    }
+
+    Clear();
+    mVertices.buffer = vertexBuffer;
+    mVertices.allocator.Reset(0);
+    mIndices.buffer = elementBuffer;
+    mIndices.allocator.Reset(0);
+}
+
+//----------------------------------------------------------------
+void MeshArena::Clear()
+{
+    for (std::uint32_t i = 0; i < mEntries.size(); ++i)
+    {
+        if (mEntries[i].alive)
+        {
+            Entry& entry = mEntries[i];
+            const std::uint32_t generation = entry.generation;
+            entry = Entry();
+            entry.generation = generation + 1;
+            mFreeEntries.push_back(i);
+        }
+    }
+
+    for (Pool* pool : { &mVertices, &mIndices })
+    {
+        pool->allocator.Reset(pool->allocator.GetSize());
+        pool->owners.clear();
+    }
+}
+
+//----------------------------------------------------------------
+const bool MeshArena::IsValid(const Handle& handle) const
+{
+    return handle.index < mEntries.size() && mEntries[handle.index].alive && mEntries[handle.index].generation == handle.generation;
+}
+
+//----------------------------------------------------------------
+void MeshArena::Resize(Pool& pool, const std::uint32_t elements)
+{
+    const size_t usedBytes = static_cast<size_t>(pool.allocator.GetSize()) * pool.elementBytes;
+
+    // The buffer ID is referenced by the VAO, so it is resized in place through a temporary copy.
+    // The copy targets leave the VAO bindings untouched.
+    GLuint copy = 0;
+    if (usedBytes > 0)
+    {
+        glGenBuffers(1, &copy);
+        System::GLState::BindBuffer(GL_COPY_WRITE_BUFFER, copy);
+        System::Program::AllocateBuffer(GL_COPY_WRITE_BUFFER, usedBytes, nullptr, System::Types::eUsage::STATIC);
+        System::GLState::BindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+    }
+
+    // Growing keeps the buffer ID, which needs mutable storage
+    System::GLState::BindBuffer(GL_COPY_WRITE_BUFFER, pool.buffer);
+    System::Program::AllocateBuffer(GL_COPY_WRITE_BUFFER, static_cast<size_t>(elements) * pool.elementBytes, nullptr, System::Types::eUsage::DYNAMIC);
+
+    if (copy != 0)
+    {
+        System::GLState::BindBuffer(GL_COPY_READ_BUFFER, copy);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+        System::GLState::DeleteBuffer(copy);
+    }
+
+    pool.allocator.Grow(elements);
+}
+
+//----------------------------------------------------------------
+const MeshArena::Allocation MeshArena::Allocate(Pool& pool, const std::uint32_t elements, const std::uint32_t entry)
+{
+    if (elements == 0)
+    {
+        return Allocation();
+    }
+
+    Allocation allocation = pool.allocator.Allocate(elements);
+    while (!allocation.IsValid())
+    {
+        const std::uint32_t size = pool.allocator.GetSize();
+        Resize(pool, std::max(std::max(size * 2, size + elements), sMinimumCapacity));
+        allocation = pool.allocator.Allocate(elements);
+    }
+
+    pool.owners[allocation.node] = entry;
+    return allocation;
+}
+
+//----------------------------------------------------------------
+void MeshArena::Free(Pool& pool, const Allocation& allocation)
+{
+    if (allocation.IsValid())
+    {
+        pool.owners.erase(allocation.node);
+        pool.allocator.Free(allocation);
+    }
+}
+
+//----------------------------------------------------------------
+void MeshArena::Write(const Pool& pool, const std::uint32_t first, const void* data, const std::uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t bytes = count * pool.elementBytes;
+    System::GLState::BindBuffer(GL_COPY_WRITE_BUFFER, pool.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, first * pool.elementBytes, bytes, data);
+    System::FrameStats::AddUpload(bytes);
+}
+
+//----------------------------------------------------------------
+const bool MeshArena::Store(const GraphicData& data, Handle& handle)
+{
+    if (!IsValid(handle))
+    {
+        std::uint32_t index;
+        if (mFreeEntries.empty())
+        {
+            index = static_cast<std::uint32_t>(mEntries.size());
+            mEntries.emplace_back();
+        }
+        else
+        {
+            index = mFreeEntries.back();
+            mFreeEntries.pop_back();
+        }
+
+        mEntries[index].alive = true;
+        handle.index = index;
+        handle.generation = mEntries[index].generation;
+    }
+
+    Entry& entry = mEntries[handle.index];
+    const std::uint32_t vertexCount = static_cast<std::uint32_t>(data.GetVertexCount());
+    const std::uint32_t indexCount = static_cast<std::uint32_t>(data.GetIndexCount());
+
+    if (entry.version == 0 || entry.range.vertexCount != vertexCount || entry.range.indexCount != indexCount)
+    {
+        Free(mVertices, entry.vertices);
+        Free(mIndices, entry.indices);
+        entry.vertices = Allocate(mVertices, vertexCount, handle.index);
+        entry.indices = Allocate(mIndices, indexCount, handle.index);
+
+        entry.range.firstVertex = entry.vertices.IsValid() ? entry.vertices.offset : 0;
+        entry.range.vertexCount = vertexCount;
+        entry.range.firstIndex = entry.indices.IsValid() ? entry.indices.offset : 0;
+        entry.range.indexCount = indexCount;
+        entry.version = 0;
+    }
+
+    if (entry.version == data.GetVersion())
+    {
+        return false;
+    }
+
+    Write(mVertices, entry.range.firstVertex, data.GetVertices().data(), vertexCount);
+    Write(mIndices, entry.range.firstIndex, data.GetIndices().data(), indexCount);
+    entry.version = data.GetVersion();
+    return true;
+}
+
+//----------------------------------------------------------------
+void MeshArena::Release(Handle& handle)
+{
+    if (!IsValid(handle))
+    {
+        return;
+    }
+
+    Entry& entry = mEntries[handle.index];
+    Free(mVertices, entry.vertices);
+    Free(mIndices, entry.indices);
+
+    const std::uint32_t generation = entry.generation;
+    entry = Entry();
+    entry.generation = generation + 1;
+    mFreeEntries.push_back(handle.index);
+
+    handle = Handle();
+}
+
+//----------------------------------------------------------------
+const MeshArena::Range MeshArena::GetRange(const Handle& handle) const
+{
+    return IsValid(handle) ? mEntries[handle.index].range : Range();
+}
+
+//----------------------------------------------------------------
+const size_t MeshArena::Compact(Pool& pool, const size_t maxBytes)
+{
+    System::GLState::BindBuffer(GL_COPY_READ_BUFFER, pool.buffer);
+    System::GLState::BindBuffer(GL_COPY_WRITE_BUFFER, pool.buffer);
+
+    size_t moved = 0;
+    while (moved < maxBytes)
+    {
+        const Allocation last = pool.allocator.GetLastUsed();
+        if (!last.IsValid())
+        {
+            break;
+        }
+
+        // Evacuate the last range into the best free range before it
+        const std::uint32_t elements = pool.allocator.GetAllocationSize(last);
+        const Allocation target = pool.allocator.Allocate(elements);
+        if (target.IsValid() && target.offset < last.offset)
+        {
+            const size_t bytes = static_cast<size_t>(elements) * pool.elementBytes;
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, last.offset * pool.elementBytes, target.offset * pool.elementBytes, bytes);
+
+            // Patch the owner, handles resolve to the new offset from now on
+            const std::uint32_t owner = pool.owners[last.node];
+            pool.owners.erase(last.node);
+            pool.owners[target.node] = owner;
+            SetOffset(pool, owner, target);
+
+            pool.allocator.Free(last);
+            moved += bytes;
+            continue;
+        }
+        pool.allocator.Free(target);
+
+        // No hole fits it: slide the first range after a hole down instead, holes then gather at the end
+        Allocation range = pool.allocator.GetFirstAfterHole();
+        if (!range.IsValid())
+        {
+            break;
+        }
+
+        const size_t source = static_cast<size_t>(range.offset) * pool.elementBytes;
+        const size_t bytes = static_cast<size_t>(pool.allocator.GetAllocationSize(range)) * pool.elementBytes;
+        const size_t distance = static_cast<size_t>(pool.allocator.Slide(range)) * pool.elementBytes;
+
+        // Copies must not overlap, move in chunks no longer than the distance, front first
+        for (size_t done = 0; done < bytes; done += distance)
+        {
+            const size_t chunk = std::min(distance, bytes - done);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source + done, source + done - distance, chunk);
+        }
+
+        SetOffset(pool, pool.owners[range.node], range);
+        moved += bytes;
+    }
+
+    System::FrameStats::AddMove(moved);
+    return moved;
+}
+
+//----------------------------------------------------------------
+void MeshArena::SetOffset(const Pool& pool, const std::uint32_t entryIndex, const Allocation& allocation)
+{
+    Entry& entry = mEntries[entryIndex];
+    if (&pool == &mVertices)
+    {
+        entry.vertices = allocation;
+        entry.range.firstVertex = allocation.offset;
+    }
+    else
+    {
+        entry.indices = allocation;
+        entry.range.firstIndex = allocation.offset;
+    }
+}
+
+//----------------------------------------------------------------
+const size_t MeshArena::Defragment(const size_t maxBytes)
+{
+    return Compact(mVertices, maxBytes) + Compact(mIndices, maxBytes);
+}
+
+//----------------------------------------------------------------
+const MeshArena::Report MeshArena::GetReport() const
+{
+    Report report;
+    report.vertices = mVertices.allocator.GetReport();
+    report.indices = mIndices.allocator.GetReport();
+    report.meshCount = mEntries.size() - mFreeEntries.size();
+    return report;
+}
+
+} // namespace Graphic
+} // namespace Vision
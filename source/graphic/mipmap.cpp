@@ -0,0 +1,299 @@
+#include <graphic/include/mipmap.h>
+
+#include <core/include/jobs.h>
+#include <core/include/simd.h>
+#include <graphic/include/pixelFormat.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace Mipmap
+{
+
+namespace
+{
+    static const float sPi = 3.14159265358979f;
+    static const float sKaiserAlpha = 4.0f;
+    static const float sSincRadius = 3.0f;  // In destination texels
+    static const size_t sRowsPerTile = 16;
+
+    /**
+     * @brief Fixed size list of source taps and weights for every destination texel of one axis.
+     */
+    struct Kernel
+    {
+        int taps = 0;
+        std::vector<int> index;
+        std::vector<float> weight;
+    };
+
+    //----------------------------------------------------------------
+    const float Sinc(const float x)
+    {
+        return std::abs(x) < 1e-5f ? 1.0f : std::sin(sPi * x) / (sPi * x);
+    }
+
+    //----------------------------------------------------------------
+    // Zeroth order modified Bessel function of the first kind, as series expansion
+    const float BesselI0(const float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        const float halfSq = x * x * 0.25f;
+        for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+        {
+            term *= halfSq / float(k * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    //----------------------------------------------------------------
+    const float Evaluate(const eFilter filter, const float x)
+    {
+        const float ax = std::abs(x);
+        if (ax >= sSincRadius)
+        {
+            return 0.0f;
+        }
+
+        switch (filter)
+        {
+        case eFilter::LANCZOS:
+            return Sinc(x) * Sinc(x / sSincRadius);
+        case eFilter::KAISER:
+        default:
+        {
+            const float r = ax / sSincRadius;
+            return Sinc(x) * BesselI0(sKaiserAlpha * std::sqrt(1.0f - r * r)) / BesselI0(sKaiserAlpha);
+        }
+        }
+    }
+
+    //----------------------------------------------------------------
+    const int Resolve(const int i, const int size, const bool wrap)
+    {
+        if (wrap)
+        {
+            return ((i % size) + size) % size;
+        }
+        return std::min(std::max(i, 0), size - 1);
+    }
+
+    //----------------------------------------------------------------
+    Kernel BuildKernel(const int srcSize, const int dstSize, const Settings& settings)
+    {
+        const float scale = float(srcSize) / float(dstSize);
+        const float support = (settings.filter == eFilter::BOX ? 0.5f : sSincRadius) * scale;
+
+        Kernel kernel;
+        kernel.taps = static_cast<int>(std::ceil(support * 2.0f)) + 1;
+        kernel.index.assign(static_cast<size_t>(dstSize) * kernel.taps, 0);
+        kernel.weight.assign(static_cast<size_t>(dstSize) * kernel.taps, 0.0f);
+
+        for (int x = 0; x < dstSize; ++x)
+        {
+            const float center = (x + 0.5f) * scale;
+            const int first = static_cast<int>(std::floor(center - support));
+
+            int* index = &kernel.index[static_cast<size_t>(x) * kernel.taps];
+            float* weight = &kernel.weight[static_cast<size_t>(x) * kernel.taps];
+            float total = 0.0f;
+
+            for (int t = 0; t < kernel.taps; ++t)
+            {
+                const int i = first + t;
+                float w;
+                if (settings.filter == eFilter::BOX)
+                {
+                    // Exact coverage of the texel by the destination footprint
+                    w = std::min(i + 1.0f, center + support) - std::max(float(i), center - support);
+                    w = std::max(w, 0.0f);
+                }
+                else
+                {
+                    w = Evaluate(settings.filter, (i + 0.5f - center) / scale);
+                }
+
+                index[t] = Resolve(i, srcSize, settings.wrap);
+                weight[t] = w;
+                total += w;
+            }
+
+            for (int t = 0; t < kernel.taps; ++t)
+            {
+                weight[t] /= total;
+            }
+        }
+
+        return kernel;
+    }
+
+    //----------------------------------------------------------------
+    // acc += px * w, on one RGBA float pixel
+    inline void MulAdd(float* acc, const float* px, const float w)
+    {
+#if defined(VISION_SIMD_SSE2)
+        _mm_storeu_ps(acc, _mm_add_ps(_mm_loadu_ps(acc), _mm_mul_ps(_mm_loadu_ps(px), _mm_set1_ps(w))));
+#else
+        acc[0] += px[0] * w;
+        acc[1] += px[1] * w;
+        acc[2] += px[2] * w;
+        acc[3] += px[3] * w;
+#endif
+    }
+
+    //----------------------------------------------------------------
+    void Clamp01(float* data, const size_t count)
+    {
+        size_t i = 0;
+#if defined(VISION_SIMD_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), zero), one));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            data[i] = std::min(std::max(data[i], 0.0f), 1.0f);
+        }
+    }
+
+    //----------------------------------------------------------------
+    void Decode(const unsigned char* src, float* dst, const size_t pixelCount, const bool gammaCorrect)
+    {
+        if (gammaCorrect)
+        {
+            Pixel::SRGBToLinear(src, dst, pixelCount * 4);
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                dst[i * 4 + 3] = src[i * 4 + 3] / 255.0f;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < pixelCount * 4; ++i)
+            {
+                dst[i] = src[i] / 255.0f;
+            }
+        }
+    }
+
+    //----------------------------------------------------------------
+    void Encode(const float* src, unsigned char* dst, const size_t pixelCount, const bool gammaCorrect)
+    {
+        if (gammaCorrect)
+        {
+            Pixel::LinearToSRGB(src, dst, pixelCount * 4);
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                dst[i * 4 + 3] = static_cast<unsigned char>(src[i * 4 + 3] * 255.0f + 0.5f);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < pixelCount * 4; ++i)
+            {
+                dst[i] = static_cast<unsigned char>(src[i] * 255.0f + 0.5f);
+            }
+        }
+    }
+} // namespace
+
+//----------------------------------------------------------------
+const int LevelCount(const int width, const int height)
+{
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+    {
+        ++levels;
+    }
+    return levels;
+}
+
+//----------------------------------------------------------------
+LevelVector GenerateChain(const unsigned char* rgba, const int width, const int height, const Settings& settings /*= Settings()*/)
+{
+    LevelVector levels(LevelCount(width, height));
+
+    levels[0].width = width;
+    levels[0].height = height;
+    levels[0].data.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+
+    std::vector<float> source(static_cast<size_t>(width) * height * 4);
+    Decode(rgba, source.data(), static_cast<size_t>(width) * height, settings.gammaCorrect);
+
+    std::vector<float> horizontal;
+    std::vector<float> target;
+
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        const int srcW = levels[level - 1].width;
+        const int srcH = levels[level - 1].height;
+        const int dstW = std::max(1, srcW / 2);
+        const int dstH = std::max(1, srcH / 2);
+
+        const Kernel kernelX = BuildKernel(srcW, dstW, settings);
+        const Kernel kernelY = BuildKernel(srcH, dstH, settings);
+
+        // Horizontal pass: srcW x srcH -> dstW x srcH
+        horizontal.assign(static_cast<size_t>(dstW) * srcH * 4, 0.0f);
+        Core::JobPool::ParallelFor(srcH, sRowsPerTile, [&](const size_t begin, const size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                const float* srcRow = &source[y * srcW * 4];
+                float* dstRow = &horizontal[y * dstW * 4];
+                for (int x = 0; x < dstW; ++x)
+                {
+                    const int* index = &kernelX.index[static_cast<size_t>(x) * kernelX.taps];
+                    const float* weight = &kernelX.weight[static_cast<size_t>(x) * kernelX.taps];
+                    for (int t = 0; t < kernelX.taps; ++t)
+                    {
+                        MulAdd(&dstRow[x * 4], &srcRow[index[t] * 4], weight[t]);
+                    }
+                }
+            }
+        });
+
+        // Vertical pass: dstW x srcH -> dstW x dstH, then quantize the finished rows
+        target.assign(static_cast<size_t>(dstW) * dstH * 4, 0.0f);
+        levels[level].width = dstW;
+        levels[level].height = dstH;
+        levels[level].data.resize(static_cast<size_t>(dstW) * dstH * 4);
+
+        Core::JobPool::ParallelFor(dstH, sRowsPerTile, [&](const size_t begin, const size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                float* dstRow = &target[y * dstW * 4];
+                const int* index = &kernelY.index[y * kernelY.taps];
+                const float* weight = &kernelY.weight[y * kernelY.taps];
+                for (int t = 0; t < kernelY.taps; ++t)
+                {
+                    const float* srcRow = &horizontal[static_cast<size_t>(index[t]) * dstW * 4];
+                    for (int x = 0; x < dstW; ++x)
+                    {
+                        MulAdd(&dstRow[x * 4], &srcRow[x * 4], weight[t]);
+                    }
+                }
+
+                Clamp01(dstRow, static_cast<size_t>(dstW) * 4);
+                Encode(dstRow, &levels[level].data[y * dstW * 4], dstW, settings.gammaCorrect);
+            }
+        });
+
+        source.swap(target);
+    }
+
+    return levels;
+}
+
+} // namespace Mipmap
+} // namespace Graphic
+} // namespace Vision
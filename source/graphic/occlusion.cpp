@@ -0,0 +1,363 @@
+#include <graphic/include/occlusion.h>
+
+#include <core/include/jobs.h>
+#include <core/include/simd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//********************************
+//     Class OcclusionCuller
+//********************************
+//----------------------------------------------------------------
+OcclusionCuller::OcclusionCuller()
+    : mViewProjection(1.0f)
+    , mTriangles()
+    , mBins()
+    , mLevels()
+{
+    for (int level = 0; level < sLevelCount; ++level)
+    {
+        mLevels[level].assign(static_cast<size_t>(sWidth >> level) * (sHeight >> level), 1.0f);
+    }
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::Begin(const System::Types::Matrix44& viewProjection)
+{
+    mViewProjection = viewProjection;
+    mTriangles.clear();
+    for (std::vector<std::uint32_t>& bin : mBins)
+    {
+        bin.clear();
+    }
+    for (std::vector<float>& level : mLevels)
+    {
+        std::fill(level.begin(), level.end(), 1.0f);
+    }
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::AddOccluder(const System::Types::VertexVector& vertices, const System::Types::IndexVector& indices, const System::Types::Matrix44& model)
+{
+    using namespace System::Types::VertexConst;
+
+    const System::Types::Matrix44 transform = mViewProjection * model;
+    const size_t vertexCount = vertices.size() / SIZE;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        Vector4 clip[3];
+        bool valid = true;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            const size_t index = indices[i + corner];
+            valid = valid && index < vertexCount;
+            if (valid)
+            {
+                const float* position = &vertices[index * SIZE + POINT_X];
+                clip[corner] = transform * Vector4(position[0], position[1], position[2], 1.0f);
+            }
+        }
+        if (valid)
+        {
+            AddTriangle(clip[0], clip[1], clip[2]);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::AddTriangle(const Vector4& a, const Vector4& b, const Vector4& c)
+{
+    // GL near plane, in front of it where z >= -w
+    const Vector4 input[3] = { a, b, c };
+    float distances[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        distances[i] = input[i].z + input[i].w;
+        inside += distances[i] >= 0.0f ? 1 : 0;
+    }
+    if (inside == 3)
+    {
+        SetupTriangle(a, b, c);
+        return;
+    }
+    if (inside == 0)
+    {
+        return;
+    }
+
+    // Cutting a corner off leaves a quad, cutting two leaves a triangle
+    Vector4 clipped[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int next = (i + 1) % 3;
+        if (distances[i] >= 0.0f)
+        {
+            clipped[count++] = input[i];
+        }
+        if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+        {
+            const float t = distances[i] / (distances[i] - distances[next]);
+            clipped[count++] = input[i] + (input[next] - input[i]) * t;
+        }
+    }
+    for (int i = 1; i + 1 < count; ++i)
+    {
+        SetupTriangle(clipped[0], clipped[i], clipped[i + 1]);
+    }
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::SetupTriangle(const Vector4& a, const Vector4& b, const Vector4& c)
+{
+    // Screen position in pixels and depth of every vertex, in double so far vertices keep precision
+    const Vector4* clip[3] = { &a, &b, &c };
+    double x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const double inverseW = 1.0 / clip[i]->w;
+        x[i] = (clip[i]->x * inverseW * 0.5 + 0.5) * sWidth;
+        y[i] = (clip[i]->y * inverseW * 0.5 + 0.5) * sHeight;
+        z[i] = clip[i]->z * inverseW * 0.5 + 0.5;
+    }
+
+    const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::fabs(area) < 1e-8 || (z[0] > 1.0 && z[1] > 1.0 && z[2] > 1.0))
+    {
+        return;
+    }
+
+    Triangle triangle;
+    const double minX = std::max(std::min(std::min(x[0], x[1]), x[2]), 0.0);
+    const double maxX = std::min(std::max(std::max(x[0], x[1]), x[2]), sWidth - 1.0);
+    const double minY = std::max(std::min(std::min(y[0], y[1]), y[2]), 0.0);
+    const double maxY = std::min(std::max(std::max(y[0], y[1]), y[2]), sHeight - 1.0);
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+    triangle.minX = static_cast<int>(minX);
+    triangle.maxX = static_cast<int>(maxX);
+    triangle.minY = static_cast<int>(minY);
+    triangle.maxY = static_cast<int>(maxY);
+
+    // Edges from every vertex to the next, flipped for clockwise triangles so inside is positive
+    const double orientation = area > 0.0 ? 1.0 : -1.0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int next = (i + 1) % 3;
+        triangle.edges[i][0] = static_cast<float>((y[i] - y[next]) * orientation);
+        triangle.edges[i][1] = static_cast<float>((x[next] - x[i]) * orientation);
+        triangle.edges[i][2] = static_cast<float>((x[i] * y[next] - y[i] * x[next]) * orientation);
+    }
+
+    const double depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    const double depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    triangle.depth[0] = static_cast<float>(depthX);
+    triangle.depth[1] = static_cast<float>(depthY);
+    triangle.depth[2] = static_cast<float>(z[0] - depthX * x[0] - depthY * y[0]);
+
+    const std::uint32_t id = static_cast<std::uint32_t>(mTriangles.size());
+    mTriangles.push_back(triangle);
+    for (int tileY = triangle.minY / sTileHeight; tileY <= triangle.maxY / sTileHeight; ++tileY)
+    {
+        for (int tileX = triangle.minX / sTileWidth; tileX <= triangle.maxX / sTileWidth; ++tileX)
+        {
+            mBins[tileY * sTilesX + tileX].push_back(id);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::Rasterize()
+{
+    // Tiles don't share pixels, so they need no synchronization
+    Core::JobPool::ParallelFor(sTilesX * sTilesY, 1, [this](const size_t begin, const size_t end)
+    {
+        for (size_t tile = begin; tile < end; ++tile)
+        {
+            RasterizeTile(static_cast<int>(tile));
+        }
+    });
+    BuildPyramid();
+}
+
+//----------------------------------------------------------------
+void OcclusionCuller::RasterizeTile(const int tile)
+{
+    const int tileX = (tile % sTilesX) * sTileWidth;
+    const int tileY = (tile / sTilesX) * sTileHeight;
+    float* depth = mLevels[0].data();
+#if defined(VISION_SIMD_AVX)
+    const bool avx = Simd::HasAVX();
+#endif
+
+    for (const std::uint32_t id : mBins[tile])
+    {
+        const Triangle& triangle = mTriangles[id];
+        // Spans of 8 pixels, aligned so they never leave the tile
+        const int minX = std::max(triangle.minX, tileX) & ~7;
+        const int maxX = std::min(triangle.maxX, tileX + sTileWidth - 1);
+        const int minY = std::max(triangle.minY, tileY);
+        const int maxY = std::min(triangle.maxY, tileY + sTileHeight - 1);
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            // Every function is evaluated at pixel centers
+            const float centerY = y + 0.5f;
+            const float edge0 = triangle.edges[0][1] * centerY + triangle.edges[0][2];
+            const float edge1 = triangle.edges[1][1] * centerY + triangle.edges[1][2];
+            const float edge2 = triangle.edges[2][1] * centerY + triangle.edges[2][2];
+            const float plane = triangle.depth[1] * centerY + triangle.depth[2];
+            float* row = depth + y * sWidth;
+
+#if defined(VISION_SIMD_AVX)
+            if (avx)
+            {
+                const float edges[3] = { edge0, edge1, edge2 };
+                RasterizeRowAVX(triangle, edges, plane, row, minX, maxX);
+                continue;
+            }
+#endif
+
+            for (int x = minX; x <= maxX; x += 8)
+            {
+#if defined(VISION_SIMD_SSE2)
+                for (int half = 0; half < 8; half += 4)
+                {
+                    const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x + half)), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+                    const __m128 e0 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(triangle.edges[0][0])), _mm_set1_ps(edge0));
+                    const __m128 e1 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(triangle.edges[1][0])), _mm_set1_ps(edge1));
+                    const __m128 e2 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(triangle.edges[2][0])), _mm_set1_ps(edge2));
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, _mm_setzero_ps()), _mm_cmpge_ps(e1, _mm_setzero_ps())), _mm_cmpge_ps(e2, _mm_setzero_ps()));
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(triangle.depth[0])), _mm_set1_ps(plane));
+                    const __m128 current = _mm_loadu_ps(row + x + half);
+                    _mm_storeu_ps(row + x + half, _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(current, z)), _mm_andnot_ps(inside, current)));
+                }
+#else
+                for (int pixel = x; pixel < x + 8; ++pixel)
+                {
+                    const float centerX = pixel + 0.5f;
+                    if (triangle.edges[0][0] * centerX + edge0 >= 0.0f && triangle.edges[1][0] * centerX + edge1 >= 0.0f && triangle.edges[2][0] * centerX + edge2 >= 0.0f)
+                    {
+                        row[pixel] = std::min(row[pixel], triangle.depth[0] * centerX + plane);
+                    }
+                }
+#endif
+            }
+        }
+    }
+}
+
+#if defined(VISION_SIMD_AVX)
+//----------------------------------------------------------------
+VISION_SIMD_TARGET("avx") void OcclusionCuller::RasterizeRowAVX(const Triangle& triangle, const float edges[3], const float plane, float* row, const int minX, const int maxX)
+{
+    for (int x = minX; x <= maxX; x += 8)
+    {
+        const __m256 centerX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+        const __m256 e0 = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(triangle.edges[0][0])), _mm256_set1_ps(edges[0]));
+        const __m256 e1 = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(triangle.edges[1][0])), _mm256_set1_ps(edges[1]));
+        const __m256 e2 = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(triangle.edges[2][0])), _mm256_set1_ps(edges[2]));
+        const __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(e1, _mm256_setzero_ps(), _CMP_GE_OQ)),
+                                            _mm256_cmp_ps(e2, _mm256_setzero_ps(), _CMP_GE_OQ));
+        const __m256 z = _mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(triangle.depth[0])), _mm256_set1_ps(plane));
+        const __m256 current = _mm256_loadu_ps(row + x);
+        _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), inside));
+    }
+}
+#endif
+
+//----------------------------------------------------------------
+void OcclusionCuller::BuildPyramid()
+{
+    for (int level = 1; level < sLevelCount; ++level)
+    {
+        const int width = sWidth >> level;
+        const int height = sHeight >> level;
+        const float* source = mLevels[level - 1].data();
+        float* target = mLevels[level].data();
+        for (int y = 0; y < height; ++y)
+        {
+            const float* bottom = source + (2 * y) * (2 * width);
+            const float* top = bottom + 2 * width;
+            for (int x = 0; x < width; ++x)
+            {
+                target[y * width + x] = std::max(std::max(bottom[2 * x], bottom[2 * x + 1]), std::max(top[2 * x], top[2 * x + 1]));
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const bool OcclusionCuller::IsVisible(const Bounds& bounds) const
+{
+    if (mTriangles.empty())
+    {
+        return true;
+    }
+
+    // Screen rectangle and nearest depth of the corners
+    float minX = std::numeric_limits<float>::max(), maxX = -std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max(), maxY = -std::numeric_limits<float>::max();
+    float nearest = std::numeric_limits<float>::max();
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const Vector4 clip = mViewProjection * Vector4(corner & 1 ? bounds.max.x : bounds.min.x,
+                                                       corner & 2 ? bounds.max.y : bounds.min.y,
+                                                       corner & 4 ? bounds.max.z : bounds.min.z, 1.0f);
+        // Boxes crossing the near plane have no bounded rectangle
+        if (clip.w <= 0.0f || clip.z < -clip.w)
+        {
+            return true;
+        }
+        const float inverseW = 1.0f / clip.w;
+        const float x = (clip.x * inverseW * 0.5f + 0.5f) * sWidth;
+        const float y = (clip.y * inverseW * 0.5f + 0.5f) * sHeight;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, clip.z * inverseW * 0.5f + 0.5f);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= sWidth || minY >= sHeight)
+    {
+        return false;
+    }
+
+    const int x0 = static_cast<int>(std::max(minX, 0.0f));
+    const int x1 = static_cast<int>(std::min(maxX, sWidth - 1.0f));
+    const int y0 = static_cast<int>(std::max(minY, 0.0f));
+    const int y1 = static_cast<int>(std::min(maxY, sHeight - 1.0f));
+
+    // Coarsest level where the rectangle is at most 2x2 texels
+    int level = 0;
+    while (level + 1 < sLevelCount && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    {
+        ++level;
+    }
+
+    const int width = sWidth >> level;
+    const float* texels = mLevels[level].data();
+    for (int y = y0 >> level; y <= y1 >> level; ++y)
+    {
+        for (int x = x0 >> level; x <= x1 >> level; ++x)
+        {
+            if (nearest <= texels[y * width + x])
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,401 @@
+#include <graphic/include/pixelFormat.h>
+
+#include <core/include/simd.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace Pixel
+{
+
+namespace
+{
+    static const int sLinearLUTSize = 8192;
+
+    //----------------------------------------------------------------
+    const float* GetSRGBToLinearLUT()
+    {
+        static float sLUT[256];
+        static const bool sInitialized = []()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = i / 255.0f;
+                sLUT[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return true;
+        }();
+        (void)sInitialized;
+        return sLUT;
+    }
+
+    //----------------------------------------------------------------
+    const unsigned char* GetLinearToSRGBLUT()
+    {
+        static unsigned char sLUT[sLinearLUTSize];
+        static const bool sInitialized = []()
+        {
+            for (int i = 0; i < sLinearLUTSize; ++i)
+            {
+                const float l = i / float(sLinearLUTSize - 1);
+                const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                sLUT[i] = static_cast<unsigned char>(std::min(255.0f, c * 255.0f + 0.5f));
+            }
+            return true;
+        }();
+        (void)sInitialized;
+        return sLUT;
+    }
+
+    //----------------------------------------------------------------
+    inline const unsigned char Div255(const unsigned int x)
+    {
+        const unsigned int t = x + 128;
+        return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+    }
+
+    //----------------------------------------------------------------
+    const GLint RowAlignment(const size_t rowBytes)
+    {
+        if (rowBytes % 8 == 0) return 8;
+        if (rowBytes % 4 == 0) return 4;
+        if (rowBytes % 2 == 0) return 2;
+        return 1;
+    }
+
+#if defined(VISION_SIMD_SSE2)
+    //----------------------------------------------------------------
+    // Exact round(x / 255) on 16-bit lanes holding products of two bytes
+    inline __m128i Div255Epu16(const __m128i x)
+    {
+        const __m128i t = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+#endif
+
+#if defined(VISION_SIMD_AVX2)
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("avx2") inline __m256i Div255Epu16(const __m256i x)
+    {
+        const __m256i t = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    }
+
+    // Kernels above the SSE2 baseline take the first pixel to process and return the first one
+    // left for the narrower paths.
+
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("avx2") const size_t ExpandRGBToRGBAAVX2(const unsigned char* src, unsigned char* dst, size_t i, const size_t pixelCount, const unsigned char alpha)
+    {
+        const __m256i mask = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                              0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alphaBits = _mm256_set1_epi32(static_cast<int>(static_cast<unsigned int>(alpha) << 24));
+        // Each lane reads 16 bytes for 4 pixels, stop while the last read stays inside the source
+        for (; i + 10 <= pixelCount; i += 8)
+        {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 12));
+            const __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            const __m256i out = _mm256_or_si256(_mm256_shuffle_epi8(in, mask), alphaBits);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), out);
+        }
+        return i;
+    }
+
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("avx2") const size_t SRGBToLinearAVX2(const unsigned char* src, float* dst, size_t i, const size_t count, const float* lut)
+    {
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+            const __m256i index = _mm256_cvtepu8_epi32(bytes);
+            _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(lut, index, 4));
+        }
+        return i;
+    }
+
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("avx2") const size_t PremultiplyAlphaAVX2(unsigned char* rgba, size_t i, const size_t pixelCount)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 8 <= pixelCount; i += 8)
+        {
+            __m256i* ptr = reinterpret_cast<__m256i*>(rgba + i * 4);
+            const __m256i px = _mm256_loadu_si256(ptr);
+            __m256i lo = _mm256_unpacklo_epi8(px, zero);
+            __m256i hi = _mm256_unpackhi_epi8(px, zero);
+            const __m256i aLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256i aHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            lo = Div255Epu16(_mm256_mullo_epi16(lo, aLo));
+            hi = Div255Epu16(_mm256_mullo_epi16(hi, aHi));
+            const __m256i out = _mm256_packus_epi16(lo, hi);
+            _mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_and_si256(px, alphaMask), _mm256_andnot_si256(alphaMask, out)));
+        }
+        return i;
+    }
+#endif
+
+#if defined(VISION_SIMD_SSSE3)
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("ssse3") const size_t ExpandRGBToRGBASSSE3(const unsigned char* src, unsigned char* dst, size_t i, const size_t pixelCount, const unsigned char alpha)
+    {
+        const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(static_cast<unsigned int>(alpha) << 24));
+        for (; i + 6 <= pixelCount; i += 4)
+        {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            const __m128i out = _mm_or_si128(_mm_shuffle_epi8(in, mask), alphaBits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), out);
+        }
+        return i;
+    }
+
+    //----------------------------------------------------------------
+    VISION_SIMD_TARGET("ssse3") const size_t ExpandGrayToRGBSSSE3(const unsigned char* src, unsigned char* dst, size_t i, const size_t pixelCount)
+    {
+        const __m128i mask0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+        const __m128i mask1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+        const __m128i mask2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+        for (; i + 16 <= pixelCount; i += 16)
+        {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i* out = reinterpret_cast<__m128i*>(dst + i * 3);
+            _mm_storeu_si128(out + 0, _mm_shuffle_epi8(in, mask0));
+            _mm_storeu_si128(out + 1, _mm_shuffle_epi8(in, mask1));
+            _mm_storeu_si128(out + 2, _mm_shuffle_epi8(in, mask2));
+        }
+        return i;
+    }
+#endif
+} // namespace
+
+//----------------------------------------------------------------
+const UploadFormat ChooseUploadFormat(const int nrChannels, const int width, const bool srgb /*= false*/)
+{
+    UploadFormat format;
+
+    switch (nrChannels)
+    {
+    case 1:
+    case 2:
+        // There are no core sRGB formats with less than 3 channels, expand those instead
+        if (!srgb)
+        {
+            const bool hasAlpha = nrChannels == 2;
+            format.internalFormat = hasAlpha ? GL_RG8 : GL_R8;
+            format.format = hasAlpha ? GL_RG : GL_RED;
+            format.channels = nrChannels;
+            format.alignment = RowAlignment(static_cast<size_t>(width) * nrChannels);
+            format.swizzle = true;
+            format.swizzleMask[0] = GL_RED;
+            format.swizzleMask[1] = GL_RED;
+            format.swizzleMask[2] = GL_RED;
+            format.swizzleMask[3] = hasAlpha ? GL_GREEN : GL_ONE;
+            break;
+        }
+        // fall through
+    case 3:
+    case 4:
+    default:
+        format.internalFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        format.format = GL_RGBA;
+        format.channels = 4;
+        format.alignment = RowAlignment(static_cast<size_t>(width) * 4);
+        break;
+    }
+
+    return format;
+}
+
+//----------------------------------------------------------------
+void ExpandRGBToRGBA(const unsigned char* src, unsigned char* dst, const size_t pixelCount, const unsigned char alpha /*= 255*/)
+{
+    size_t i = 0;
+
+#if defined(VISION_SIMD_AVX2)
+    if (Simd::HasAVX2())
+    {
+        i = ExpandRGBToRGBAAVX2(src, dst, i, pixelCount, alpha);
+    }
+#endif
+
+#if defined(VISION_SIMD_SSSE3)
+    if (Simd::HasSSSE3())
+    {
+        i = ExpandRGBToRGBASSSE3(src, dst, i, pixelCount, alpha);
+    }
+#endif
+
+    for (; i < pixelCount; ++i)
+    {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+//----------------------------------------------------------------
+void ExpandGrayToRGB(const unsigned char* src, unsigned char* dst, const size_t pixelCount)
+{
+    size_t i = 0;
+
+#if defined(VISION_SIMD_SSSE3)
+    if (Simd::HasSSSE3())
+    {
+        i = ExpandGrayToRGBSSSE3(src, dst, i, pixelCount);
+    }
+#endif
+
+    for (; i < pixelCount; ++i)
+    {
+        dst[i * 3 + 0] = src[i];
+        dst[i * 3 + 1] = src[i];
+        dst[i * 3 + 2] = src[i];
+    }
+}
+
+//----------------------------------------------------------------
+void ConvertToRGBA(const unsigned char* src, const int nrChannels, unsigned char* dst, const size_t pixelCount)
+{
+    switch (nrChannels)
+    {
+    case 4:
+        std::copy(src, src + pixelCount * 4, dst);
+        break;
+    case 3:
+        ExpandRGBToRGBA(src, dst, pixelCount);
+        break;
+    case 2:
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            dst[i * 4 + 0] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i * 2];
+            dst[i * 4 + 3] = src[i * 2 + 1];
+        }
+        break;
+    case 1:
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            dst[i * 4 + 0] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i];
+            dst[i * 4 + 3] = 255;
+        }
+        break;
+    default:
+        assert(false && "Unsupported channel count");
+    }
+}
+
+//----------------------------------------------------------------
+void SRGBToLinear(const unsigned char* src, float* dst, const size_t count)
+{
+    const float* lut = GetSRGBToLinearLUT();
+    size_t i = 0;
+
+#if defined(VISION_SIMD_AVX2)
+    if (Simd::HasAVX2())
+    {
+        i = SRGBToLinearAVX2(src, dst, i, count, lut);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        dst[i] = lut[src[i]];
+    }
+}
+
+//----------------------------------------------------------------
+void LinearToSRGB(const float* src, unsigned char* dst, const size_t count)
+{
+    const unsigned char* lut = GetLinearToSRGBLUT();
+    const float scale = float(sLinearLUTSize - 1);
+    size_t i = 0;
+
+#if defined(VISION_SIMD_SSE2)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scaleV = _mm_set1_ps(scale);
+        alignas(16) int index[4];
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            v = _mm_min_ps(_mm_max_ps(v, zero), one);
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvtps_epi32(_mm_mul_ps(v, scaleV)));
+            dst[i + 0] = lut[index[0]];
+            dst[i + 1] = lut[index[1]];
+            dst[i + 2] = lut[index[2]];
+            dst[i + 3] = lut[index[3]];
+        }
+    }
+#endif
+
+    // NaN goes to 0 and rounding is to nearest even, like _mm_max_ps and _mm_cvtps_epi32 above
+    for (; i < count; ++i)
+    {
+        const float v = !(src[i] > 0.0f) ? 0.0f : std::min(src[i], 1.0f);
+        dst[i] = lut[std::lrint(v * scale)];
+    }
+}
+
+//----------------------------------------------------------------
+void PremultiplyAlpha(unsigned char* rgba, const size_t pixelCount)
+{
+    size_t i = 0;
+
+#if defined(VISION_SIMD_AVX2)
+    if (Simd::HasAVX2())
+    {
+        i = PremultiplyAlphaAVX2(rgba, i, pixelCount);
+    }
+#endif
+
+#if defined(VISION_SIMD_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            __m128i* ptr = reinterpret_cast<__m128i*>(rgba + i * 4);
+            const __m128i px = _mm_loadu_si128(ptr);
+            __m128i lo = _mm_unpacklo_epi8(px, zero);
+            __m128i hi = _mm_unpackhi_epi8(px, zero);
+            const __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            lo = Div255Epu16(_mm_mullo_epi16(lo, aLo));
+            hi = Div255Epu16(_mm_mullo_epi16(hi, aHi));
+            const __m128i out = _mm_packus_epi16(lo, hi);
+            _mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(px, alphaMask), _mm_andnot_si128(alphaMask, out)));
+        }
+    }
+#endif
+
+    for (; i < pixelCount; ++i)
+    {
+        unsigned char* px = rgba + i * 4;
+        px[0] = Div255(px[0] * px[3]);
+        px[1] = Div255(px[1] * px[3]);
+        px[2] = Div255(px[2] * px[3]);
+    }
+}
+
+//----------------------------------------------------------------
+void FlipVertical(unsigned char* data, const int width, const int height, const int bytesPerPixel)
+{
+    // std::swap_ranges over whole rows is vectorized by the compiler already
+    const size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+    for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom)
+    {
+        unsigned char* topRow = data + top * rowBytes;
+        std::swap_ranges(topRow, topRow + rowBytes, data + bottom * rowBytes);
+    }
+}
+
+} // namespace Pixel
+} // namespace Graphic
+} // namespace Vision
@@ -0,0 +1,121 @@
+#include <graphic/include/renderQueue.h>
+
+#include <cstring>
+#include <utility>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+namespace
+{
+    static const std::uint32_t sPassShift = 62;
+    static const std::uint64_t sProgramMask = (1ull << RenderQueue::sProgramBits) - 1;
+    static const std::uint64_t sMaterialMask = (1ull << RenderQueue::sMaterialBits) - 1;
+    static const std::uint64_t sDepthMask = (1ull << RenderQueue::sDepthBits) - 1;
+
+    //----------------------------------------------------------------
+    // Top bits of the float: for positive values their order is the order of the values,
+    // with a precision relative to the depth
+    inline const std::uint64_t QuantizeDepth(const float depth)
+    {
+        if (!(depth > 0.0f))
+        {
+            return 0;
+        }
+
+        std::uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits >> (31 - RenderQueue::sDepthBits)) & sDepthMask;
+    }
+} // namespace
+
+//********************************
+//     Class RenderQueue
+//********************************
+//----------------------------------------------------------------
+const std::uint64_t RenderQueue::MakeKey(const ePass pass, const std::uint32_t program, const std::uint32_t material, const float depth)
+{
+    const std::uint64_t passBits = static_cast<std::uint64_t>(pass) << sPassShift;
+    const std::uint64_t programBits = program & sProgramMask;
+    const std::uint64_t materialBits = material & sMaterialMask;
+    const std::uint64_t depthBits = QuantizeDepth(depth);
+
+    if (pass == ePass::TRANSPARENT_PASS)
+    {
+        // Back to front first, state only breaks ties
+        const std::uint32_t depthShift = sPassShift - sDepthBits;
+        const std::uint32_t programShift = depthShift - sProgramBits;
+        const std::uint32_t materialShift = programShift - sMaterialBits;
+        return passBits | ((~depthBits & sDepthMask) << depthShift) | (programBits << programShift) | (materialBits << materialShift);
+    }
+
+    // Grouped by state, front to back inside each group
+    const std::uint32_t materialShift = sDepthBits;
+    const std::uint32_t programShift = materialShift + sMaterialBits;
+    return passBits | (programBits << programShift) | (materialBits << materialShift) | depthBits;
+}
+
+//----------------------------------------------------------------
+const RenderQueue::ePass RenderQueue::GetPass(const std::uint64_t key)
+{
+    return static_cast<ePass>(key >> sPassShift);
+}
+
+//----------------------------------------------------------------
+void RenderQueue::Sort()
+{
+    const size_t count = mItems.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Histograms of every byte in one read of the keys
+    size_t histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+    for (const Item& item : mItems)
+    {
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            ++histograms[byte][(item.key >> (byte * 8)) & 0xFF];
+        }
+    }
+
+    mScratch.resize(count);
+    Item* source = mItems.data();
+    Item* destination = mScratch.data();
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        size_t* histogram = histograms[byte];
+
+        // Every key has the same byte here, the pass wouldn't move anything
+        if (histogram[(source[0].key >> (byte * 8)) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket)
+        {
+            const size_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            destination[histogram[(source[i].key >> (byte * 8)) & 0xFF]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != mItems.data())
+    {
+        mItems.swap(mScratch);
+    }
+}
+
+} // namespace Graphic
+} // namespace Vision
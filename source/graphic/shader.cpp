@@ -14,6 +14,7 @@ namespace Graphic
 Shader::Shader()
 	: mId(0)
 	, mBuffers()
+	, mProgram(nullptr)
 {}
 
 //----------------------------------------------------------------
@@ -24,13 +25,21 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
 }
 
 //----------------------------------------------------------------
-void Shader::Initialize(const char* vertexPath, const char* fragmentPath)
+Shader::~Shader()
 {
-	// NOTE: check if FileString survives to provide the code
-	System::Types::UInt vertexShader = System::GL::CompileShader(Util::FileString(vertexPath).c_str(), GL_VERTEX_SHADER);
-	System::Types::UInt fragmentShader = System::GL::CompileShader(Util::FileString(fragmentPath).c_str(), GL_FRAGMENT_SHADER);
+	if (mProgram != nullptr)
+	{
+		System::ProgramRegistry::Release(*mProgram);
+	}
+}
 
-	System::GL::CreateProgram(mId, vertexShader, fragmentShader);
+//----------------------------------------------------------------
+void Shader::Initialize(const char* vertexPath, const char* fragmentPath)
+{
+	mProgram = &System::ProgramRegistry::Request(vertexPath, fragmentPath, System::ShaderDefines());
+	System::ProgramRegistry::Finish(*mProgram);
+	const bool ready = mProgram->state == System::ProgramRegistry::eState::READY;
+	mId = !ready ? 0 : mProgram->pipeline != 0 ? mProgram->pipeline : mProgram->program;
 }
 
 } // namespace Graphic
@@ -0,0 +1,373 @@
+#include <graphic/include/spatialGrid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//********************************
+//     Class SpatialGrid
+//********************************
+//----------------------------------------------------------------
+SpatialGrid::SpatialGrid(const float cellSize /*= 16.0f*/)
+    : mCellSize(cellSize)
+    , mCells()
+    , mCellIndices()
+    , mItems()
+    , mOversized()
+    , mCount(0)
+{}
+
+//----------------------------------------------------------------
+void SpatialGrid::Clear()
+{
+    mCells.clear();
+    mCellIndices.clear();
+    mItems.clear();
+    mOversized.clear();
+    mCount = 0;
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Insert(const std::uint32_t id, const Bounds& bounds)
+{
+    if (id < mItems.size() && !mItems[id].bounds.IsEmpty())
+    {
+        Move(id, bounds);
+        return;
+    }
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    if (id >= mItems.size())
+    {
+        mItems.resize(id + 1);
+    }
+    mItems[id].bounds = bounds;
+    Place(id);
+    ++mCount;
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Remove(const std::uint32_t id)
+{
+    if (id < mItems.size() && !mItems[id].bounds.IsEmpty())
+    {
+        Unplace(id);
+        mItems[id] = Item();
+        --mCount;
+    }
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Move(const std::uint32_t id, const Bounds& bounds)
+{
+    if (id >= mItems.size() || mItems[id].bounds.IsEmpty())
+    {
+        Insert(id, bounds);
+        return;
+    }
+    if (bounds.IsEmpty())
+    {
+        Remove(id);
+        return;
+    }
+
+    // Items staying in their cell, or oversized, only have their bounds updated
+    Item& item = mItems[id];
+    const glm::ivec3 coords = GetCoords(bounds.GetCenter());
+    const bool fits = GetLooseBounds(coords).Contains(bounds);
+    if (item.oversized ? !fits : (fits && GetKey(coords) == item.key))
+    {
+        item.bounds = bounds;
+        return;
+    }
+
+    Unplace(id);
+    item.bounds = bounds;
+    Place(id);
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Refresh()
+{}
+
+//----------------------------------------------------------------
+const glm::ivec3 SpatialGrid::GetCoords(const System::Types::Vector3& point) const
+{
+    const glm::vec3 cell = glm::floor(point / mCellSize);
+    const glm::vec3 range(static_cast<float>(sCellRange - 1));
+    return glm::ivec3(glm::clamp(cell, -range, range));
+}
+
+//----------------------------------------------------------------
+const std::uint64_t SpatialGrid::GetKey(const glm::ivec3& coords) const
+{
+    const std::uint64_t x = static_cast<std::uint64_t>(coords.x + sCellRange);
+    const std::uint64_t y = static_cast<std::uint64_t>(coords.y + sCellRange);
+    const std::uint64_t z = static_cast<std::uint64_t>(coords.z + sCellRange);
+    return x | (y << 21) | (z << 42);
+}
+
+//----------------------------------------------------------------
+const Bounds SpatialGrid::GetLooseBounds(const glm::ivec3& coords) const
+{
+    Bounds bounds;
+    bounds.min = (System::Types::Vector3(coords) - 0.5f) * mCellSize;
+    bounds.max = (System::Types::Vector3(coords) + 1.5f) * mCellSize;
+    return bounds;
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Place(const std::uint32_t id)
+{
+    // Checked against the loose bounds themselves, so queries can't miss an item by rounding
+    Item& item = mItems[id];
+    const glm::ivec3 coords = GetCoords(item.bounds.GetCenter());
+    const Bounds loose = GetLooseBounds(coords);
+    item.oversized = !loose.Contains(item.bounds);
+    if (item.oversized)
+    {
+        item.slot = static_cast<std::uint32_t>(mOversized.size());
+        mOversized.push_back(id);
+        return;
+    }
+
+    item.key = GetKey(coords);
+    const auto found = mCellIndices.emplace(item.key, static_cast<std::uint32_t>(mCells.size()));
+    if (found.second)
+    {
+        mCells.emplace_back();
+        mCells.back().bounds = loose;
+        mCells.back().key = item.key;
+    }
+    item.cell = found.first->second;
+    Cell& cell = mCells[item.cell];
+    item.slot = static_cast<std::uint32_t>(cell.items.size());
+    cell.items.push_back(id);
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::Unplace(const std::uint32_t id)
+{
+    const Item& item = mItems[id];
+    std::vector<std::uint32_t>& items = item.oversized ? mOversized : mCells[item.cell].items;
+
+    // Removals swap with the last element, so they don't shift the others
+    const std::uint32_t last = items.back();
+    items[item.slot] = last;
+    mItems[last].slot = item.slot;
+    items.pop_back();
+    if (item.oversized || !items.empty())
+    {
+        return;
+    }
+
+    const std::uint32_t index = item.cell;
+    mCellIndices.erase(mCells[index].key);
+    if (index + 1 != mCells.size())
+    {
+        mCells[index] = std::move(mCells.back());
+        mCellIndices[mCells[index].key] = index;
+        for (const std::uint32_t moved : mCells[index].items)
+        {
+            mItems[moved].cell = index;
+        }
+    }
+    mCells.pop_back();
+}
+
+//----------------------------------------------------------------
+template <typename Visitor>
+void SpatialGrid::VisitCells(const Bounds& bounds, const Visitor& visit) const
+{
+    // Loose bounds reach half a cell out of their cell, rounding may add one more on the edges
+    const System::Types::Vector3 margin(mCellSize);
+    const glm::ivec3 first = GetCoords(bounds.min - margin);
+    const glm::ivec3 last = GetCoords(bounds.max + margin);
+    const glm::dvec3 range = glm::dvec3(last - first) + 1.0;
+
+    // Looking every cell of the range up only pays when it has fewer cells than the grid
+    if (range.x * range.y * range.z < static_cast<double>(mCells.size()))
+    {
+        glm::ivec3 coords;
+        for (coords.z = first.z; coords.z <= last.z; ++coords.z)
+        {
+            for (coords.y = first.y; coords.y <= last.y; ++coords.y)
+            {
+                for (coords.x = first.x; coords.x <= last.x; ++coords.x)
+                {
+                    const auto cell = mCellIndices.find(GetKey(coords));
+                    if (cell != mCellIndices.end() && bounds.Overlaps(mCells[cell->second].bounds))
+                    {
+                        visit(mCells[cell->second]);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    for (const Cell& cell : mCells)
+    {
+        if (bounds.Overlaps(cell.bounds))
+        {
+            visit(cell);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::QueryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& ids) const
+{
+    for (const Cell& cell : mCells)
+    {
+        const Frustum::eOverlap overlap = frustum.Classify(cell.bounds);
+        if (overlap == Frustum::eOverlap::INSIDE)
+        {
+            ids.insert(ids.end(), cell.items.begin(), cell.items.end());
+        }
+        else if (overlap == Frustum::eOverlap::PARTIAL)
+        {
+            for (const std::uint32_t id : cell.items)
+            {
+                if (frustum.Intersects(mItems[id].bounds))
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+    }
+
+    for (const std::uint32_t id : mOversized)
+    {
+        if (frustum.Intersects(mItems[id].bounds))
+        {
+            ids.push_back(id);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::QueryBounds(const Bounds& bounds, std::vector<std::uint32_t>& ids) const
+{
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+
+    VisitCells(bounds, [&](const Cell& cell)
+    {
+        if (bounds.Contains(cell.bounds))
+        {
+            ids.insert(ids.end(), cell.items.begin(), cell.items.end());
+            return;
+        }
+        for (const std::uint32_t id : cell.items)
+        {
+            if (bounds.Overlaps(mItems[id].bounds))
+            {
+                ids.push_back(id);
+            }
+        }
+    });
+
+    for (const std::uint32_t id : mOversized)
+    {
+        if (bounds.Overlaps(mItems[id].bounds))
+        {
+            ids.push_back(id);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void SpatialGrid::QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& ids) const
+{
+    const float radiusSquared = radius * radius;
+    Bounds box;
+    box.Grow(center - System::Types::Vector3(radius));
+    box.Grow(center + System::Types::Vector3(radius));
+
+    VisitCells(box, [&](const Cell& cell)
+    {
+        if (cell.bounds.GetSquaredDistance(center) > radiusSquared)
+        {
+            return;
+        }
+        for (const std::uint32_t id : cell.items)
+        {
+            if (mItems[id].bounds.GetSquaredDistance(center) <= radiusSquared)
+            {
+                ids.push_back(id);
+            }
+        }
+    });
+
+    for (const std::uint32_t id : mOversized)
+    {
+        if (mItems[id].bounds.GetSquaredDistance(center) <= radiusSquared)
+        {
+            ids.push_back(id);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const bool SpatialGrid::Raycast(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, RayHit& hit) const
+{
+    const System::Types::Vector3 inverseDirection = 1.0f / direction;
+    float closest = maxDistance;
+    bool found = false;
+
+    const auto test = [&](const std::uint32_t id)
+    {
+        const float distance = mItems[id].bounds.GetRayEntry(origin, inverseDirection, closest);
+        if (distance >= 0.0f && (!found || distance < closest))
+        {
+            closest = distance;
+            hit.id = id;
+            hit.distance = distance;
+            found = true;
+        }
+    };
+
+    for (const std::uint32_t id : mOversized)
+    {
+        test(id);
+    }
+
+    // Cells by entry distance, the items of a cell can't be closer than the cell
+    std::vector<std::pair<float, const Cell*>> cells;
+    for (const Cell& cell : mCells)
+    {
+        const float entry = cell.bounds.GetRayEntry(origin, inverseDirection, closest);
+        if (entry >= 0.0f)
+        {
+            cells.emplace_back(entry, &cell);
+        }
+    }
+    std::sort(cells.begin(), cells.end(), [](const std::pair<float, const Cell*>& a, const std::pair<float, const Cell*>& b) { return a.first < b.first; });
+
+    for (const std::pair<float, const Cell*>& cell : cells)
+    {
+        if (found && cell.first > closest)
+        {
+            break;
+        }
+        for (const std::uint32_t id : cell.second->items)
+        {
+            test(id);
+        }
+    }
+    return found;
+}
+
+} // namespace Graphic
+} // namespace Vision
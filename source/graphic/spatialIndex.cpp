@@ -0,0 +1,25 @@
+#include <graphic/include/spatialIndex.h>
+
+#include <graphic/include/bvh.h>
+#include <graphic/include/spatialGrid.h>
+
+namespace Vision
+{
+namespace Graphic
+{
+
+//----------------------------------------------------------------
+std::unique_ptr<ISpatialIndex> CreateSpatialIndex(const eSpatialStructure structure)
+{
+    switch (structure)
+    {
+    case eSpatialStructure::GRID:
+        return std::unique_ptr<ISpatialIndex>(new SpatialGrid());
+    case eSpatialStructure::BVH:
+    default:
+        return std::unique_ptr<ISpatialIndex>(new BVH());
+    }
+}
+
+} // namespace Graphic
+} // namespace Vision
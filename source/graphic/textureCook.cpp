@@ -0,0 +1,260 @@
+#include <graphic/include/textureCook.h>
+
+#include <graphic/include/blockCompression.h>
+#include <graphic/include/pixelFormat.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace Vision
+{
+namespace Graphic
+{
+namespace TextureCook
+{
+
+namespace
+{
+    static const std::uint32_t sMagic = 0x58455456; // "VTEX"
+    static const std::uint32_t sVersion = 1;
+
+    struct FileHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t format;
+        std::uint32_t flags;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t levelCount;
+    };
+
+    struct LevelHeader
+    {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t byteSize;
+    };
+
+    static const std::uint32_t sFlagSRGB = 1 << 0;
+
+    //----------------------------------------------------------------
+    const System::Types::eTextureFormat ChooseFormat(const System::Types::TextureLevel& base, const eCompression compression)
+    {
+        switch (compression)
+        {
+        case eCompression::BC1:
+            return System::Types::eTextureFormat::BC1;
+        case eCompression::BC3:
+            return System::Types::eTextureFormat::BC3;
+        case eCompression::BC7:
+            return System::Types::eTextureFormat::BC7;
+        case eCompression::AUTO:
+            for (size_t i = 3; i < base.data.size(); i += 4)
+            {
+                if (base.data[i] != 255)
+                {
+                    return System::Types::eTextureFormat::BC7;
+                }
+            }
+            return System::Types::eTextureFormat::BC1;
+        case eCompression::NONE:
+        default:
+            return System::Types::eTextureFormat::RGBA8;
+        }
+    }
+
+    //----------------------------------------------------------------
+    void Compress(System::Types::TextureInfo& texture, const Settings& settings)
+    {
+        const System::Types::eTextureFormat format = ChooseFormat(texture.levels.front(), settings.compression);
+        if (format == System::Types::eTextureFormat::RGBA8)
+        {
+            return;
+        }
+
+        std::vector<std::vector<unsigned char>> compressed(texture.levels.size());
+        for (size_t i = 0; i < texture.levels.size(); ++i)
+        {
+            const System::Types::TextureLevel& level = texture.levels[i];
+            compressed[i].resize(BlockCompression::ImageBytes(format, level.width, level.height));
+            BlockCompression::Encode(level.data.data(), level.width, level.height, format, compressed[i].data());
+        }
+
+        // Lower levels are blurrier and compress better, the base level decides
+        const System::Types::TextureLevel& base = texture.levels.front();
+        std::vector<unsigned char> decoded(base.data.size());
+        BlockCompression::Decode(compressed.front().data(), base.width, base.height, format, decoded.data());
+
+        const double psnr = BlockCompression::PSNR(base.data.data(), decoded.data(), static_cast<size_t>(base.width) * base.height, format == System::Types::eTextureFormat::BC1);
+        if (psnr < settings.minPSNR)
+        {
+            LOG_STDERR("Texture '" << texture.name << "' compresses at " << psnr << " dB, kept uncompressed.");
+            return;
+        }
+
+        for (size_t i = 0; i < texture.levels.size(); ++i)
+        {
+            texture.levels[i].data.swap(compressed[i]);
+        }
+        texture.format = format;
+    }
+} // namespace
+
+//----------------------------------------------------------------
+void Cook(System::Types::TextureInfo& texture, const Settings& settings /*= Settings()*/)
+{
+    if (texture.IsCooked())
+    {
+        if (texture.format == System::Types::eTextureFormat::RGBA8)
+        {
+            Compress(texture, settings);
+        }
+        return;
+    }
+
+    if (texture.data == NULL)
+    {
+        return;
+    }
+
+    const size_t pixelCount = static_cast<size_t>(texture.width) * texture.height;
+    std::vector<unsigned char> rgba(pixelCount * 4);
+    Pixel::ConvertToRGBA(texture.data, texture.nrChannels, rgba.data(), pixelCount);
+
+    if (settings.generateMips)
+    {
+        texture.levels = Mipmap::GenerateChain(rgba.data(), texture.width, texture.height, settings.mips);
+    }
+    else
+    {
+        texture.levels.resize(1);
+        texture.levels[0].width = texture.width;
+        texture.levels[0].height = texture.height;
+        texture.levels[0].data.swap(rgba);
+    }
+
+    stbi_image_free(texture.data);
+    texture.data = NULL;
+    texture.nrChannels = 4;
+
+    Compress(texture, settings);
+}
+
+//----------------------------------------------------------------
+const bool Save(const System::Types::TextureInfo& texture, const char* path)
+{
+    if (!texture.IsCooked())
+    {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        LOG_STDERR("Failed writing cooked texture \'" << path << "\'.");
+        return false;
+    }
+
+    FileHeader header = {};
+    header.magic = sMagic;
+    header.version = sVersion;
+    header.format = static_cast<std::uint32_t>(texture.format);
+    header.flags = texture.srgb ? sFlagSRGB : 0;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.levelCount = static_cast<std::uint32_t>(texture.levels.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const System::Types::TextureLevel& level : texture.levels)
+    {
+        const LevelHeader levelHeader = { std::uint32_t(level.width), std::uint32_t(level.height), std::uint32_t(level.data.size()) };
+        file.write(reinterpret_cast<const char*>(&levelHeader), sizeof(levelHeader));
+        file.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+    }
+
+    return file.good();
+}
+
+//----------------------------------------------------------------
+const bool Load(System::Types::TextureInfo& texture, const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        LOG_STDERR("Failed reading cooked texture \'" << path << "\'.");
+        return false;
+    }
+
+    FileHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != sMagic || header.version != sVersion || header.format > static_cast<std::uint32_t>(System::Types::eTextureFormat::BC7))
+    {
+        LOG_STDERR("Invalid cooked texture \'" << path << "\'.");
+        return false;
+    }
+
+    // Sizes are checked before allocating anything, a corrupt header must not size the levels
+    const std::uint32_t maxSize = static_cast<std::uint32_t>(std::numeric_limits<int>::max());
+    if (header.width == 0 || header.height == 0 || header.width > maxSize || header.height > maxSize
+        || header.levelCount > static_cast<std::uint32_t>(Mipmap::LevelCount(header.width, header.height)))
+    {
+        LOG_STDERR("Invalid cooked texture \'" << path << "\'.");
+        return false;
+    }
+
+    const System::Types::eTextureFormat format = static_cast<System::Types::eTextureFormat>(header.format);
+    std::vector<System::Types::TextureLevel> levels(header.levelCount);
+    for (std::uint32_t i = 0; i < header.levelCount; ++i)
+    {
+        System::Types::TextureLevel& level = levels[i];
+        LevelHeader levelHeader = {};
+        file.read(reinterpret_cast<char*>(&levelHeader), sizeof(levelHeader));
+        if (!file)
+        {
+            LOG_STDERR("Truncated cooked texture \'" << path << "\'.");
+            return false;
+        }
+
+        // Every level halves the previous one, so its size bounds the data read
+        if (levelHeader.width != std::max(1u, header.width >> i) || levelHeader.height != std::max(1u, header.height >> i)
+            || levelHeader.byteSize != BlockCompression::ImageBytes(format, levelHeader.width, levelHeader.height))
+        {
+            LOG_STDERR("Invalid cooked texture \'" << path << "\'.");
+            return false;
+        }
+
+        level.width = levelHeader.width;
+        level.height = levelHeader.height;
+        level.data.resize(levelHeader.byteSize);
+        file.read(reinterpret_cast<char*>(level.data.data()), levelHeader.byteSize);
+    }
+
+    if (!file || levels.empty())
+    {
+        LOG_STDERR("Truncated cooked texture \'" << path << "\'.");
+        return false;
+    }
+
+    texture.width = header.width;
+    texture.height = header.height;
+    texture.nrChannels = 4;
+    texture.srgb = (header.flags & sFlagSRGB) != 0;
+    texture.format = format;
+    texture.levels.swap(levels);
+    return true;
+}
+
+//----------------------------------------------------------------
+const bool IsCookedPath(const char* path)
+{
+    const size_t length = std::strlen(path);
+    const size_t extension = std::strlen(sCookedExtension);
+
+    return length >= extension && std::strcmp(path + length - extension, sCookedExtension) == 0;
+}
+
+} // namespace TextureCook
+} // namespace Graphic
+} // namespace Vision
@@ -2,9 +2,16 @@
 #define STB_IMAGE_IMPLEMENTATION
 
 #include <thirdparty.h>
+#include <testing/include/benchmark.h>
 #include <testing/include/testing.h>
+#include <cstring>
 
 int main(int arc, char* argv[]) 
 {
+	// Measures the engine's data structures without opening a window
+	if (arc > 1 && std::strcmp(argv[1], "--benchmark") == 0)
+	{
+		return Vision::Testing::RunBenchmarks();
+	}
 	return Vision::Testing::Run();
 }
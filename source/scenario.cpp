@@ -1,5 +1,8 @@
 #include <scenario.h>
 
+#include <system/include/frameStats.h>
+#include <algorithm>
+
 namespace Vision
 {
 namespace Scenario
@@ -8,6 +11,8 @@ namespace Scenario
 using Vector = System::Types::Vector3;
 using Matrix = System::Types::Matrix44;
 
+static const size_t sDefragmentBytesPerFrame = 256 * 1024;  // Per buffer
+
 //********************************
 //     Class Camera
 //********************************
@@ -15,6 +20,7 @@ using Matrix = System::Types::Matrix44;
 Camera::Camera()
     : mPosition(0.0f, 0.0f, 10.0f)
     , mView()
+    , mProjection(glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 700.0f))
 {
     mView = glm::lookAt(mPosition, Vector(0.0f), System::Types::VECTOR_UP);
 }
@@ -38,10 +44,23 @@ const Matrix& Camera::GetView() const
 //----------------------------------------------------------------
 Scenario::Scenario()
     : mObjects()
+    , mMeshes()
     , mCameras({ Camera() })
     , mCurrentCamera(0)
     , mDrawingInfo()
-{}
+    , mArena()
+    , mQueue()
+    , mIndices()
+    , mVisible()
+    , mOcclusion()
+    , mOcclusionCulling(true)
+    , mLod()
+    , mLodStates()
+    , mDraws()
+{
+    mIndices[static_cast<size_t>(eLayer::STATIC)] = Graphic::CreateSpatialIndex(Graphic::eSpatialStructure::BVH);
+    mIndices[static_cast<size_t>(eLayer::DYNAMIC)] = Graphic::CreateSpatialIndex(Graphic::eSpatialStructure::GRID);
+}
 
 //----------------------------------------------------------------
 Scenario::~Scenario()
@@ -54,14 +73,139 @@ Scenario::~Scenario()
 void Scenario::LoadObject(Object& object)
 {
     mObjects.push_back(object);
-    mDrawingInfo.indexCount += object.GetGraphicData().GetIndexCount();
+    mMeshes.emplace_back();
+    mLodStates.emplace_back();
+    if (!object.IsHidden())
+    {
+        GetIndex(object.GetLayer()).Insert(static_cast<std::uint32_t>(mObjects.size() - 1), object.GetGraphicData().GetWorldBounds());
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::RemoveObject(const int index)
+{
+    assert(index < mObjects.size());
+    for (Graphic::MeshArena::Handle& mesh : mMeshes.at(index))
+    {
+        mArena.Release(mesh);
+    }
+    mObjects.erase(mObjects.begin() + index);
+    mMeshes.erase(mMeshes.begin() + index);
+    mLodStates.erase(mLodStates.begin() + index);
+
+    // Every following object changed index
+    ResetIndices();
+}
+
+//----------------------------------------------------------------
+void Scenario::ResetIndices(const eLayer layer /*= eLayer::COUNT*/)
+{
+    for (size_t i = 0; i < static_cast<size_t>(eLayer::COUNT); ++i)
+    {
+        if (layer == eLayer::COUNT || static_cast<size_t>(layer) == i)
+        {
+            mIndices[i]->Clear();
+        }
+    }
+    for (size_t i = 0; i < mObjects.size(); ++i)
+    {
+        Object& object = mObjects[i];
+        if (!object.IsHidden() && (layer == eLayer::COUNT || object.GetLayer() == layer))
+        {
+            GetIndex(object.GetLayer()).Insert(static_cast<std::uint32_t>(i), object.GetGraphicData().GetWorldBounds());
+        }
+    }
 }
 
 //----------------------------------------------------------------
 void Scenario::HideObject(const int index, const bool hidden /*= true */)
 {
     assert(index < mObjects.size());
-    mObjects.at(index).SetHidden(hidden);
+    Object& object = mObjects.at(index);
+    object.SetHidden(hidden);
+    if (hidden)
+    {
+        GetIndex(object.GetLayer()).Remove(static_cast<std::uint32_t>(index));
+    }
+    else
+    {
+        GetIndex(object.GetLayer()).Insert(static_cast<std::uint32_t>(index), object.GetGraphicData().GetWorldBounds());
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::SetObjectModel(const int index, const Matrix& model)
+{
+    assert(index < mObjects.size());
+    Object& object = mObjects.at(index);
+    object.SetModel(model);
+    if (!object.IsHidden())
+    {
+        GetIndex(object.GetLayer()).Move(static_cast<std::uint32_t>(index), object.GetGraphicData().GetWorldBounds());
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::SetObjectLayer(const int index, const eLayer layer)
+{
+    assert(index < mObjects.size() && layer != eLayer::COUNT);
+    Object& object = mObjects.at(index);
+    if (object.GetLayer() == layer)
+    {
+        return;
+    }
+
+    GetIndex(object.GetLayer()).Remove(static_cast<std::uint32_t>(index));
+    object.SetLayer(layer);
+    if (!object.IsHidden())
+    {
+        GetIndex(layer).Insert(static_cast<std::uint32_t>(index), object.GetGraphicData().GetWorldBounds());
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::SetLayerStructure(const eLayer layer, const Graphic::eSpatialStructure structure)
+{
+    assert(layer != eLayer::COUNT);
+    mIndices[static_cast<size_t>(layer)] = Graphic::CreateSpatialIndex(structure);
+    ResetIndices(layer);
+}
+
+//----------------------------------------------------------------
+void Scenario::QueryBounds(const Graphic::Bounds& bounds, std::vector<std::uint32_t>& indices) const
+{
+    for (const auto& index : mIndices)
+    {
+        index->QueryBounds(bounds, indices);
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::QuerySphere(const Vector& center, const float radius, std::vector<std::uint32_t>& indices) const
+{
+    for (const auto& index : mIndices)
+    {
+        index->QuerySphere(center, radius, indices);
+    }
+}
+
+//----------------------------------------------------------------
+const bool Scenario::Pick(const Vector& origin, const Vector& direction, const float maxDistance, Graphic::ISpatialIndex::RayHit& hit) const
+{
+    // Every layer after the first only has to beat the closest hit so far
+    float closest = maxDistance;
+    bool found = false;
+    for (const auto& index : mIndices)
+    {
+        Graphic::ISpatialIndex::RayHit layerHit;
+        if (index->Raycast(origin, direction, closest, layerHit))
+        {
+            closest = layerHit.distance;
+            hit = layerHit;
+            found = true;
+        }
+    }
+    return found;
 }
 
 //----------------------------------------------------------------
@@ -73,25 +217,147 @@ const System::DrawingInfo& Scenario::GetDrawingInfo()
 //----------------------------------------------------------------
 void Scenario::GenDrawingInfo()
 {
+    using RenderQueue = Graphic::RenderQueue;
+
     // TODO: adapt this to take graphicData's drawType
     mDrawingInfo.drawType = System::eDrawType::TRIANGLES;
 
+    // Every object is drawn by the same program for now
+    const std::uint32_t program = 0;
+    const Camera& camera = GetCurrentCamera();
+    const Matrix& view = camera.GetView();
+
+    // Hidden objects aren't in the indices
+    const Graphic::Frustum frustum(camera.GetViewProjection());
+    mVisible.clear();
+    for (const auto& index : mIndices)
+    {
+        index->Refresh();
+        index->QueryFrustum(frustum, mVisible);
+    }
+    System::FrameStats::AddCull(mObjects.size(), mVisible.size());
+    if (mOcclusionCulling)
+    {
+        CullOccluded(camera.GetViewProjection());
+    }
+    SelectLods(camera);
+
+    mQueue.Clear();
+    for (std::uint32_t i = 0; i < mDraws.size(); ++i)
+    {
+        // Distance along the view direction of the object's origin
+        Object& object = mObjects[mDraws[i].object];
+        const float depth = -(view * object.GetGraphicData().GetModel()[3]).z;
+        const RenderQueue::ePass pass = object.IsTransparent() ? RenderQueue::ePass::TRANSPARENT_PASS : RenderQueue::ePass::OPAQUE_PASS;
+        mQueue.Add(RenderQueue::MakeKey(pass, program, object.GetLod(mDraws[i].level).GetMaterialID(), depth), i);
+    }
+    mQueue.Sort();
+
     mDrawingInfo.indexCount = 0;
-    for (auto& object : mObjects)
+    mDrawingInfo.ranges.clear();
+    mDrawingInfo.models.clear();
+    for (const RenderQueue::Item& item : mQueue.GetItems())
     {
-        if (!object.IsHidden())
+        const Draw& draw = mDraws[item.index];
+        Object& object = mObjects[draw.object];
+        const Graphic::MeshArena::Range mesh = mArena.GetRange(mMeshes[draw.object][draw.level]);
+
+        System::DrawRange range;
+        range.indexCount = mesh.indexCount;
+        range.firstIndex = mesh.firstIndex;
+        range.baseVertex = static_cast<GLint>(mesh.firstVertex);
+        range.graphicData = &object.GetLod(draw.level);
+        range.transparent = RenderQueue::GetPass(item.key) == RenderQueue::ePass::TRANSPARENT_PASS;
+        range.fade = draw.fade;
+        mDrawingInfo.ranges.push_back(range);
+        mDrawingInfo.models.push_back(object.GetGraphicData().GetModel());
+
+        mDrawingInfo.indexCount += mesh.indexCount;
+    }
+}
+
+//----------------------------------------------------------------
+void Scenario::SelectLods(const Camera& camera)
+{
+    mLod.Begin(camera.GetPosition(), camera.GetProjection());
+    mDraws.clear();
+    size_t fullTriangles = 0;
+    size_t drawnTriangles = 0;
+    for (const std::uint32_t index : mVisible)
+    {
+        Object& object = mObjects[index];
+        Graphic::LodSelector::State& state = mLodStates[index];
+        const std::vector<float>& errors = object.GetLodErrors();
+        mLod.Select(state, GetIndex(object.GetLayer()).GetBounds(index), errors.data(), errors.size());
+
+        // The level fading out covers the pixels the new one leaves, with a negative fade
+        const float fade = mLod.GetFade(state);
+        mDraws.push_back({ index, state.level, fade });
+        drawnTriangles += object.GetLod(state.level).GetIndexCount() / 3;
+        if (mLod.IsFading(state))
         {
-            mDrawingInfo.indexCount += object.GetGraphicData().GetIndexCount();
+            mDraws.push_back({ index, state.previous, fade - 1.0f });
+            drawnTriangles += object.GetLod(state.previous).GetIndexCount() / 3;
         }
+        fullTriangles += object.GetGraphicData().GetIndexCount() / 3;
     }
+    System::FrameStats::AddLod(fullTriangles, drawnTriangles);
+}
+
+//----------------------------------------------------------------
+void Scenario::CullOccluded(const Matrix& viewProjection)
+{
+    mOcclusion.Begin(viewProjection);
+    for (const std::uint32_t index : mVisible)
+    {
+        Object& object = mObjects[index];
+        if (object.IsOccluder())
+        {
+            const Graphic::GraphicData& graphicData = object.GetGraphicData();
+            mOcclusion.AddOccluder(graphicData.GetVertices(), graphicData.GetIndices(), graphicData.GetModel());
+        }
+    }
+    if (mOcclusion.GetTriangleCount() == 0)
+    {
+        return;
+    }
+    mOcclusion.Rasterize();
+
+    // Occluders are kept, they may be behind their own depth by rounding
+    const size_t tested = mVisible.size();
+    mVisible.erase(std::remove_if(mVisible.begin(), mVisible.end(), [this](const std::uint32_t index)
+    {
+        Object& object = mObjects[index];
+        return !object.IsOccluder() && !mOcclusion.IsVisible(GetIndex(object.GetLayer()).GetBounds(index));
+    }), mVisible.end());
+    System::FrameStats::AddOcclusion(tested, mVisible.size());
 }
 
 //----------------------------------------------------------------
 void Scenario::SetAllBuffers(System::Types::UInt& vertexBuffer, System::Types::UInt& elementBuffer)
+{
+    mArena.SetBuffers(vertexBuffer, elementBuffer);
+    for (size_t i = 0; i < mObjects.size(); ++i)
+    {
+        // Every level stays stored, switching levels uploads nothing
+        const Object& object = mObjects[i];
+        mMeshes[i].resize(object.GetLodCount());
+        for (size_t level = 0; level < object.GetLodCount(); ++level)
+        {
+            mArena.Store(object.GetLod(level), mMeshes[i][level]);
+        }
+    }
+    mArena.Defragment(sDefragmentBytesPerFrame);
+
+    GenDrawingInfo();
+}
+
+//----------------------------------------------------------------
+void Scenario::ApplyAtlas()
 {
     for (auto& object : mObjects)
     {
-        object.GetGraphicData().SetBuffers(vertexBuffer, elementBuffer);
+        object.ApplyAtlas();
     }
 }
 
@@ -1,8 +1,16 @@
 #pragma once
 
+#include <graphic/include/frustum.h>
 #include <graphic/include/graphic.h>
+#include <graphic/include/lod.h>
+#include <graphic/include/meshArena.h>
+#include <graphic/include/occlusion.h>
+#include <graphic/include/renderQueue.h>
+#include <graphic/include/spatialIndex.h>
 #include <system/include/types.h>
 #include <thirdparty.h>
+#include <cassert>
+#include <memory>
 #include <vector>
 
 
@@ -18,6 +26,7 @@ class Camera
     
     Vector mPosition;
     Matrix mView;
+    Matrix mProjection;
 
 public:
     Camera();
@@ -39,6 +48,19 @@ public:
         mView = glm::scale(mView, Vector(0.9));
     }
     const Matrix& GetView() const;
+    // World position, the view may have been rotated or scaled around the origin since it was placed
+    inline const Vector GetPosition() const { return Vector(glm::inverse(mView)[3]); }
+    inline const Matrix& GetProjection() const { return mProjection; }
+    inline void SetProjection(const Matrix& projection) { mProjection = projection; }
+    inline const Matrix GetViewProjection() const { return mProjection * mView; }
+};
+
+// Objects of every layer are kept in their own spatial index
+enum class eLayer
+{
+    STATIC,     // Rarely moved
+    DYNAMIC,    // Moved most frames
+    COUNT
 };
 
 class Object
@@ -46,7 +68,12 @@ class Object
     using GraphicData = Graphic::GraphicData;
 
     bool mHidden = false;
+    bool mTransparent = false;
+    bool mOccluder = false;
+    eLayer mLayer = eLayer::STATIC;
     GraphicData mGraphicData;
+    std::vector<GraphicData> mLods;             // Coarser levels of detail, from the finest
+    std::vector<float> mLodErrors = { 0.0f };   // Geometric error of every level, mGraphicData first
 
 public:
     Object()
@@ -59,8 +86,38 @@ public:
 
     inline const bool IsHidden() { return mHidden; }
     inline void SetHidden(const bool val) { mHidden = val; }
+    // Transparent objects are blended after the opaque ones, from back to front
+    inline const bool IsTransparent() const { return mTransparent; }
+    inline void SetTransparent(const bool val) { mTransparent = val; }
+    // Occluders are rasterized for occlusion culling, best kept to few big objects with simple geometry
+    inline const bool IsOccluder() const { return mOccluder; }
+    inline void SetOccluder(const bool val) { mOccluder = val; }
+    inline const eLayer GetLayer() const { return mLayer; }
+    inline void SetLayer(const eLayer val) { mLayer = val; }
     inline const GraphicData& GetGraphicData() { return mGraphicData; }
     inline void SetGraphicData(const GraphicData val) { mGraphicData = val; }
+    inline void SetModel(const System::Types::Matrix44& model) { mGraphicData.SetModel(model); }
+    inline const bool ApplyAtlas()
+    {
+        bool applied = mGraphicData.ApplyAtlas();
+        for (GraphicData& lod : mLods)
+        {
+            applied = lod.ApplyAtlas() || applied;
+        }
+        return applied;
+    }
+
+    // Adds a coarser level of detail, drawn with the model of the object. Its error is how far its surface strays
+    // from the full mesh in world units, at least the error of the level before
+    inline void AddLod(const GraphicData& graphicData, const float error)
+    {
+        assert(error >= mLodErrors.back());
+        mLods.push_back(graphicData);
+        mLodErrors.push_back(error);
+    }
+    inline const size_t GetLodCount() const { return mLodErrors.size(); }
+    inline const std::vector<float>& GetLodErrors() const { return mLodErrors; }
+    inline const GraphicData& GetLod(const size_t level) const { return level == 0 ? mGraphicData : mLods[level - 1]; }
 };
 
 class Scenario
@@ -68,12 +125,40 @@ class Scenario
     using DrawingInfo = System::DrawingInfo;
     using ObjectVector = std::vector<Object>;
     using CameraVector = std::vector<Camera>;
+    using MeshVector = std::vector<std::vector<Graphic::MeshArena::Handle>>;
     using Matrix = System::Types::Matrix44;
 
+    // Level of an object drawn this frame, what the render queue sorts
+    struct Draw
+    {
+        std::uint32_t object = 0;
+        std::uint32_t level = 0;
+        float fade = 1.0f;          // See System::DrawRange::fade
+    };
+
     ObjectVector mObjects;
+    MeshVector mMeshes;             // Mesh of every level of every object in mArena, by object index
     CameraVector mCameras;
     int mCurrentCamera;
     DrawingInfo mDrawingInfo;
+    Graphic::MeshArena mArena;
+    Graphic::RenderQueue mQueue;
+    // World bounds of the objects that aren't hidden by layer, by object index
+    std::unique_ptr<Graphic::ISpatialIndex> mIndices[static_cast<size_t>(eLayer::COUNT)];
+    std::vector<std::uint32_t> mVisible;
+    Graphic::OcclusionCuller mOcclusion;
+    bool mOcclusionCulling;
+    Graphic::LodSelector mLod;
+    std::vector<Graphic::LodSelector::State> mLodStates;    // By object index
+    std::vector<Draw> mDraws;
+
+    inline Graphic::ISpatialIndex& GetIndex(const eLayer layer) { return *mIndices[static_cast<size_t>(layer)]; }
+    // Inserts the objects of the layer again, or of every layer for COUNT
+    void ResetIndices(const eLayer layer = eLayer::COUNT);
+    // Leaves the visible objects hidden behind the visible occluders out of mVisible
+    void CullOccluded(const Matrix& viewProjection);
+    // Fills mDraws with the level, or the two levels cross fading, of every visible object
+    void SelectLods(const Camera& camera);
 
     void GenDrawingInfo();
 
@@ -81,10 +166,37 @@ public:
     Scenario();
     ~Scenario();
     void LoadObject(Object& object);
+    // Removes an object and gives its geometry space back to the arena
+    void RemoveObject(const int index);
     void HideObject(const int index, const bool hidden = true);
+    // Moves an object, its place in the spatial index is refitted on the next SetAllBuffers
+    void SetObjectModel(const int index, const Matrix& model);
+    void SetObjectLayer(const int index, const eLayer layer);
+    // Structure indexing the objects of a layer; a BVH for static objects and a grid for dynamic ones by default
+    void SetLayerStructure(const eLayer layer, const Graphic::eSpatialStructure structure);
+    // Objects behind occluders are left out of the drawing info, on by default. Without occluders in view it costs nothing
+    inline void SetOcclusionCulling(const bool enabled) { mOcclusionCulling = enabled; }
+    inline const Graphic::OcclusionCuller& GetOcclusionCuller() const { return mOcclusion; }
+    // Level of detail selection of every object with levels, qualityBias trades detail for triangles globally
+    inline void SetLodSettings(const Graphic::LodSelector::Settings& settings) { mLod.SetSettings(settings); }
+    inline const Graphic::LodSelector::Settings& GetLodSettings() const { return mLod.GetSettings(); }
     const DrawingInfo& GetDrawingInfo();
     
+    // Stores every object in the given buffers, uploading only the changed ones, and rebuilds the drawing info
+    // from the objects inside the current camera's frustum, in render queue order: opaque objects by state
+    // then front to back, transparent ones back to front
     void SetAllBuffers(System::Types::UInt& vertexBuffer, System::Types::UInt& elementBuffer);
+    // Moves the textures of every object to the atlas pages recorded in the TextureLoader
+    void ApplyAtlas();
+
+    // Spatial queries on the object bounds of every layer, hidden objects excluded. They see the objects as of
+    // the last SetAllBuffers and append object indices.
+    void QueryBounds(const Graphic::Bounds& bounds, std::vector<std::uint32_t>& indices) const;
+    void QuerySphere(const System::Types::Vector3& center, const float radius, std::vector<std::uint32_t>& indices) const;
+    // Object whose bounds the ray enters first, hit.id is its index
+    const bool Pick(const System::Types::Vector3& origin, const System::Types::Vector3& direction, const float maxDistance, Graphic::ISpatialIndex::RayHit& hit) const;
+
+    inline const Graphic::MeshArena::Report GetArenaReport() const { return mArena.GetReport(); }
     
     inline Camera& GetCurrentCamera() { return mCameras.at(mCurrentCamera); }
     inline const Matrix& GetCurrentCameraView() { return mCameras.at(mCurrentCamera).GetView(); }
@@ -0,0 +1,29 @@
+#include <system/include/frameStats.h>
+
+namespace Vision
+{
+namespace System
+{
+
+FrameStats FrameStats::mInstance;
+
+//********************************
+//     Class FrameStats
+//********************************
+//----------------------------------------------------------------
+FrameStats::FrameStats()
+    : mCurrent()
+    , mLastFrame()
+    , mFrameCount(0)
+{}
+
+//----------------------------------------------------------------
+void FrameStats::EndFrame()
+{
+    mInstance.mLastFrame = mInstance.mCurrent;
+    mInstance.mCurrent = Counters();
+    ++mInstance.mFrameCount;
+}
+
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,277 @@
+#include <system/include/glState.h>
+
+#include <system/include/frameStats.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace Vision
+{
+namespace System
+{
+
+GLState GLState::mInstance;
+
+namespace
+{
+    //----------------------------------------------------------------
+    inline const std::uint64_t PairKey(const std::uint32_t high, const std::uint32_t low)
+    {
+        return (static_cast<std::uint64_t>(high) << 32) | low;
+    }
+} // namespace
+
+//********************************
+//     Class GLState
+//********************************
+//----------------------------------------------------------------
+GLState::GLState()
+    : mProgram(sUnknown)
+    , mPipeline(sUnknown)
+    , mVertexArray(sUnknown)
+    , mActiveUnit(sUnknown)
+    , mDepthMask(-1)
+    , mBlendSource(sUnknown)
+    , mBlendDestination(sUnknown)
+    , mBuffers()
+    , mIndexedBuffers()
+    , mTextures()
+    , mCapabilities()
+    , mUniforms()
+{
+    std::fill(std::begin(mSamplers), std::end(mSamplers), sUnknown);
+}
+
+//----------------------------------------------------------------
+const bool GLState::Elide(const bool unchanged)
+{
+    FrameStats::AddStateCall(unchanged);
+    return unchanged;
+}
+
+//----------------------------------------------------------------
+void GLState::Invalidate()
+{
+    mInstance.mProgram = sUnknown;
+    mInstance.mPipeline = sUnknown;
+    mInstance.mVertexArray = sUnknown;
+    mInstance.mActiveUnit = sUnknown;
+    std::fill(std::begin(mInstance.mSamplers), std::end(mInstance.mSamplers), sUnknown);
+    mInstance.mDepthMask = -1;
+    mInstance.mBlendSource = sUnknown;
+    mInstance.mBlendDestination = sUnknown;
+    mInstance.mBuffers.clear();
+    mInstance.mIndexedBuffers.clear();
+    mInstance.mTextures.clear();
+    mInstance.mCapabilities.clear();
+    mInstance.mUniforms.clear();
+}
+
+//----------------------------------------------------------------
+void GLState::UseProgram(const GLuint program)
+{
+    if (!Elide(mInstance.mProgram == program))
+    {
+        glUseProgram(program);
+        mInstance.mProgram = program;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::DeleteProgram(const GLuint program)
+{
+    glDeleteProgram(program);
+
+    mInstance.mProgram = mInstance.mProgram == program ? sUnknown : mInstance.mProgram;
+    for (auto uniform = mInstance.mUniforms.begin(); uniform != mInstance.mUniforms.end();)
+    {
+        uniform = static_cast<GLuint>(uniform->first >> 32) == program ? mInstance.mUniforms.erase(uniform) : std::next(uniform);
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindProgramPipeline(const GLuint pipeline)
+{
+    if (!Elide(mInstance.mPipeline == pipeline))
+    {
+        glBindProgramPipeline(pipeline);
+        mInstance.mPipeline = pipeline;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::DeleteProgramPipeline(const GLuint pipeline)
+{
+    glDeleteProgramPipelines(1, &pipeline);
+
+    mInstance.mPipeline = mInstance.mPipeline == pipeline ? 0 : mInstance.mPipeline;
+}
+
+//----------------------------------------------------------------
+void GLState::BindVertexArray(const GLuint vertexArray)
+{
+    if (!Elide(mInstance.mVertexArray == vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+        mInstance.mVertexArray = vertexArray;
+        mInstance.mBuffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindBuffer(const GLenum target, const GLuint buffer)
+{
+    auto bound = mInstance.mBuffers.find(target);
+    if (!Elide(bound != mInstance.mBuffers.end() && bound->second == buffer))
+    {
+        glBindBuffer(target, buffer);
+        mInstance.mBuffers[target] = buffer;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindBufferBase(const GLenum target, const GLuint index, const GLuint buffer)
+{
+    const std::uint64_t key = PairKey(target, index);
+    auto bound = mInstance.mIndexedBuffers.find(key);
+    if (!Elide(bound != mInstance.mIndexedBuffers.end() && bound->second.buffer == buffer && bound->second.size == 0))
+    {
+        glBindBufferBase(target, index, buffer);
+        mInstance.mIndexedBuffers[key] = { buffer, 0, 0 };
+        mInstance.mBuffers[target] = buffer;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size)
+{
+    const std::uint64_t key = PairKey(target, index);
+    auto bound = mInstance.mIndexedBuffers.find(key);
+    const bool unchanged = bound != mInstance.mIndexedBuffers.end() && bound->second.buffer == buffer
+        && bound->second.offset == offset && bound->second.size == size;
+    if (!Elide(unchanged))
+    {
+        glBindBufferRange(target, index, buffer, offset, size);
+        mInstance.mIndexedBuffers[key] = { buffer, offset, size };
+        mInstance.mBuffers[target] = buffer;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::DeleteBuffer(const GLuint buffer)
+{
+    glDeleteBuffers(1, &buffer);
+
+    // GL unbinds a deleted buffer from the current context, its name may come back later
+    for (auto& bound : mInstance.mBuffers)
+    {
+        bound.second = bound.second == buffer ? 0 : bound.second;
+    }
+    for (auto& bound : mInstance.mIndexedBuffers)
+    {
+        bound.second = bound.second.buffer == buffer ? BufferRange() : bound.second;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::ActiveTexture(const GLuint unit)
+{
+    assert(unit < sTextureUnits);
+    if (!Elide(mInstance.mActiveUnit == unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        mInstance.mActiveUnit = unit;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindTexture(const GLuint unit, const GLenum target, const GLuint texture)
+{
+    ActiveTexture(unit);
+
+    const std::uint64_t key = PairKey(unit, target);
+    auto bound = mInstance.mTextures.find(key);
+    if (!Elide(bound != mInstance.mTextures.end() && bound->second == texture))
+    {
+        glBindTexture(target, texture);
+        mInstance.mTextures[key] = texture;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BindSampler(const GLuint unit, const GLuint sampler)
+{
+    assert(unit < sTextureUnits);
+    if (!Elide(mInstance.mSamplers[unit] == sampler))
+    {
+        glBindSampler(unit, sampler);
+        mInstance.mSamplers[unit] = sampler;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::DeleteTexture(const GLuint texture)
+{
+    glDeleteTextures(1, &texture);
+
+    for (auto& bound : mInstance.mTextures)
+    {
+        bound.second = bound.second == texture ? 0 : bound.second;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::SetEnabled(const GLenum capability, const bool enabled)
+{
+    auto current = mInstance.mCapabilities.find(capability);
+    if (!Elide(current != mInstance.mCapabilities.end() && current->second == enabled))
+    {
+        if (enabled)
+        {
+            glEnable(capability);
+        }
+        else
+        {
+            glDisable(capability);
+        }
+        mInstance.mCapabilities[capability] = enabled;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::DepthMask(const bool write)
+{
+    if (!Elide(mInstance.mDepthMask == static_cast<GLint>(write)))
+    {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+        mInstance.mDepthMask = write;
+    }
+}
+
+//----------------------------------------------------------------
+void GLState::BlendFunc(const GLenum source, const GLenum destination)
+{
+    if (!Elide(mInstance.mBlendSource == source && mInstance.mBlendDestination == destination))
+    {
+        glBlendFunc(source, destination);
+        mInstance.mBlendSource = source;
+        mInstance.mBlendDestination = destination;
+    }
+}
+
+//----------------------------------------------------------------
+const bool GLState::SetUniformValue(const GLuint program, const GLint location, const void* value, const std::uint32_t size)
+{
+    UniformValue& cached = mInstance.mUniforms[PairKey(program, static_cast<std::uint32_t>(location))];
+    if (Elide(cached.size == size && std::memcmp(cached.bytes, value, size) == 0))
+    {
+        return false;
+    }
+
+    std::memcpy(cached.bytes, value, size);
+    cached.size = size;
+    return true;
+}
+
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <cstddef>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief Singleton of per-frame counters of the work sent to GL.
+ *
+ * Counters accumulate during a frame; EndFrame moves them to the last frame and starts over.
+ */
+class FrameStats
+{
+public:
+    struct Counters
+    {
+        size_t bytesUploaded = 0;   // Vertex and index bytes sent to GL buffers
+        size_t bufferUploads = 0;   // Number of buffer uploads
+        size_t bytesMoved = 0;      // Bytes copied inside GL buffers to defragment them
+        size_t bytesStreamed = 0;   // Per-frame data written for GL: commands, transforms and uniforms
+        size_t streamStalls = 0;    // Waits for the GPU before reusing a stream region
+        size_t drawCalls = 0;       // Draw commands issued to GL
+        size_t drawnMeshes = 0;     // Meshes drawn by those commands
+        size_t stateCalls = 0;      // State changes sent to GL through GLState
+        size_t stateCallsElided = 0;// State changes GLState skipped, the state was already set
+        size_t culledObjects = 0;   // Objects left out of the frame, hidden or outside the view
+        size_t occludedObjects = 0; // Objects in the view left out of the frame, behind occluders
+        size_t lodTrianglesSaved = 0;   // Triangles of the full meshes of the drawn objects not drawn thanks to coarser levels
+    };
+
+private:
+    static FrameStats mInstance;
+
+    Counters mCurrent;
+    Counters mLastFrame;
+    size_t mFrameCount;
+
+    FrameStats();
+
+public:
+    static inline void AddUpload(const size_t bytes)
+    {
+        mInstance.mCurrent.bytesUploaded += bytes;
+        ++mInstance.mCurrent.bufferUploads;
+    }
+
+    static inline void AddMove(const size_t bytes)
+    {
+        mInstance.mCurrent.bytesMoved += bytes;
+    }
+
+    static inline void AddStream(const size_t bytes)
+    {
+        mInstance.mCurrent.bytesStreamed += bytes;
+    }
+
+    static inline void AddStateCall(const bool elided)
+    {
+        ++(elided ? mInstance.mCurrent.stateCallsElided : mInstance.mCurrent.stateCalls);
+    }
+
+    static inline void AddStreamStall()
+    {
+        ++mInstance.mCurrent.streamStalls;
+    }
+
+    static inline void AddDrawCall(const size_t meshes)
+    {
+        ++mInstance.mCurrent.drawCalls;
+        mInstance.mCurrent.drawnMeshes += meshes;
+    }
+
+    static inline void AddCull(const size_t tested, const size_t visible)
+    {
+        mInstance.mCurrent.culledObjects += tested - visible;
+    }
+
+    static inline void AddOcclusion(const size_t tested, const size_t visible)
+    {
+        mInstance.mCurrent.occludedObjects += tested - visible;
+    }
+
+    // Levels cross fading draw both, so a frame may draw more than the full meshes
+    static inline void AddLod(const size_t fullTriangles, const size_t drawnTriangles)
+    {
+        mInstance.mCurrent.lodTrianglesSaved += fullTriangles > drawnTriangles ? fullTriangles - drawnTriangles : 0;
+    }
+
+    /**
+     * @brief Closes the current frame, its counters become the ones of the last frame.
+     */
+    static void EndFrame();
+
+    static inline const Counters& GetCurrentFrame() { return mInstance.mCurrent; }
+    static inline const Counters& GetLastFrame() { return mInstance.mLastFrame; }
+    static inline const size_t GetFrameCount() { return mInstance.mFrameCount; }
+};
+
+} // namespace System
+} // namespace Vision
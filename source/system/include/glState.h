@@ -0,0 +1,126 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/types.h>
+#include <system/include/uniform.h>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief Singleton shadow of the GL context state, skips the calls that wouldn't change it.
+ *
+ * Tracks the bound program, VAO, buffers, textures and samplers per unit, enable bits, depth
+ * mask, blend function and the last value written to every uniform. State starts unknown, so
+ * the first call of each kind always reaches GL. Code touching that state without going
+ * through here must call Invalidate afterwards. Issued and elided calls are counted in
+ * FrameStats.
+ */
+class GLState
+{
+    static const GLuint sUnknown = 0xFFFFFFFF;
+    static const GLuint sTextureUnits = 32;
+
+    struct BufferRange
+    {
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;    // 0 for the whole buffer
+    };
+
+    struct UniformValue
+    {
+        std::uint8_t bytes[sizeof(Types::Matrix44)];
+        std::uint32_t size = 0;
+    };
+
+    static GLState mInstance;
+
+    GLuint mProgram;
+    GLuint mPipeline;
+    GLuint mVertexArray;
+    GLuint mActiveUnit;
+    GLuint mSamplers[sTextureUnits];
+    GLint mDepthMask;
+    GLenum mBlendSource;
+    GLenum mBlendDestination;
+    std::unordered_map<GLenum, GLuint> mBuffers;                // By target
+    std::unordered_map<std::uint64_t, BufferRange> mIndexedBuffers; // By target and index
+    std::unordered_map<std::uint64_t, GLuint> mTextures;        // By unit and target
+    std::unordered_map<GLenum, bool> mCapabilities;
+    std::unordered_map<std::uint64_t, UniformValue> mUniforms;  // By program and location
+
+    GLState();
+
+    static const bool Elide(const bool unchanged);
+    static const bool SetUniformValue(const GLuint program, const GLint location, const void* value, const std::uint32_t size);
+
+public:
+    /**
+     * @brief Forgets everything, the next call of each kind reaches GL.
+     */
+    static void Invalidate();
+
+    static void UseProgram(const GLuint program);
+    // Also forgets the uniforms written to it, the name may come back for another program
+    static void DeleteProgram(const GLuint program);
+    // Only used while no program is, see UseProgram(0)
+    static void BindProgramPipeline(const GLuint pipeline);
+    static void DeleteProgramPipeline(const GLuint pipeline);
+
+    // Binding a VAO also changes the element buffer binding, which belongs to the VAO
+    static void BindVertexArray(const GLuint vertexArray);
+    static void BindBuffer(const GLenum target, const GLuint buffer);
+    // Also binds the buffer to the generic binding of the target, like GL does
+    static void BindBufferBase(const GLenum target, const GLuint index, const GLuint buffer);
+    static void BindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size);
+    static void DeleteBuffer(const GLuint buffer);
+
+    static void ActiveTexture(const GLuint unit);
+    // Makes the unit active as well, so the texture can be set up right after
+    static void BindTexture(const GLuint unit, const GLenum target, const GLuint texture);
+    static void BindSampler(const GLuint unit, const GLuint sampler);
+    static void DeleteTexture(const GLuint texture);
+
+    static void SetEnabled(const GLenum capability, const bool enabled);
+    static void DepthMask(const bool write);
+    static void BlendFunc(const GLenum source, const GLenum destination);
+
+    // Uniform of the program in use, compared with the last value written to the location
+    template <typename T>
+    static void SetUniform(const GLint location, const T& value)
+    {
+        assert(mInstance.mProgram != sUnknown);
+        SetUniform(mInstance.mProgram, location, value);
+    }
+
+    // Uniform of any program, the stages of a pipeline for instance
+    template <typename T>
+    static void SetUniform(const GLuint program, const GLint location, const T& value)
+    {
+        static_assert(sizeof(T) <= sizeof(UniformValue::bytes), "Uniform larger than the cache");
+
+        // GL ignores location -1, so does the cache
+        if (location >= 0 && SetUniformValue(program, location, &value, sizeof(T)))
+        {
+            if (program == mInstance.mProgram)
+            {
+                UniformTraits<T>::Upload(location, value);
+            }
+            else
+            {
+                UniformTraits<T>::UploadTo(program, location, value);
+            }
+        }
+    }
+
+    static inline const GLuint GetProgram() { return mInstance.mProgram; }
+};
+
+} // namespace System
+} // namespace Vision
@@ -7,9 +7,21 @@
 #include <system/include/types.h>
 #include <fileManager.h>
 #include <graphic/include/graphic.h>
+#include <system/include/glState.h>
+#include <system/include/shaderPreprocessor.h>
+#include <system/include/shaderVariants.h>
+#include <system/include/streamBuffer.h>
+#include <system/include/uniform.h>
+#include <string>
+#include <utility>
 
 namespace Vision
 {
+namespace Graphic
+{
+    class GraphicData;
+} // namespace Graphic
+
 namespace System
 {
 enum eDrawType
@@ -17,37 +29,159 @@ enum eDrawType
     TRIANGLES = GL_TRIANGLES
 };
 
+// Indices of one mesh inside the shared buffers
+struct DrawRange
+{
+    Types::UInt indexCount = 0;
+    Types::UInt firstIndex = 0;
+    GLint baseVertex = 0;
+    const Graphic::GraphicData* graphicData = nullptr;  // Owner of the textures bound for the range
+    bool transparent = false;                           // Blended over what is behind, without writing depth
+    // Share of the pixels drawn, dithered: 1 draws them all, (0, 1) a level fading in and
+    // [-1, 0) one fading out, with the complementary pattern of the level fading in by 1 + fade
+    float fade = 1.0f;
+};
+
 struct DrawingInfo
 {
     eDrawType drawType = eDrawType::TRIANGLES;
-    Types::UInt indexCount = 0;
+    Types::UInt indexCount = 0;     // Sum of every range
+    std::vector<DrawRange> ranges;
+    std::vector<Types::Matrix44> models;    // Model matrix of every range, same order
+};
+
+// Record read by glMultiDrawElementsIndirect, layout fixed by GL
+struct DrawElementsIndirectCommand
+{
+    GLuint count = 0;
+    GLuint instanceCount = 1;
+    GLuint firstIndex = 0;
+    GLint baseVertex = 0;
+    GLuint baseInstance = 0;
+};
+
+enum class eSubmission
+{
+    MULTI_DRAW_INDIRECT,    // Commands in a GL buffer, ARB_multi_draw_indirect (core since GL 4.3)
+    MULTI_DRAW              // Commands in client arrays, glMultiDrawElementsBaseVertex
 };
 
 class Program
 {
+    static const GLuint sModelsBinding = 0;     // Shader storage binding of the model matrices
+    static const GLuint sFadesBinding = 1;      // Shader storage binding of the fade of every range
+
     GLuint mVertexArrayObject;
     GLuint mVertexArrayBuffer;
     GLuint mElementArrayBuffer;
+    StreamBuffer mDrawStream;           // Model matrices, fades and indirect commands of every frame
+    GLintptr mCommandsOffset;           // Of the commands of the frame in mDrawStream
+    size_t mStorageAlignment;           // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    Uniform<GLint> mDrawOffset = Uniform<GLint>("drawOffset");
+    eSubmission mSubmission;
+
+    // Commands of the frame without indirect draws, kept to reuse their storage
+    std::vector<GLsizei> mCounts;
+    std::vector<const void*> mIndexOffsets;
+    std::vector<GLint> mBaseVertices;
+
+    ShaderVariants mVariants;
+    ShaderVariants::Variant* mVariant = nullptr;    // In use, ID is its program or pipeline
      
-    const GLuint CompileShader(const char* code, const GLuint type);
-    void LinkProgram(const GLuint vertexID, const GLuint fragmentID);
-    void CheckErrors(GLuint shader, const bool isShader);
-    void CleanShaders(const GLuint vertexID, const GLuint fragmentID);
     void GenerateBuffers();
+    void UploadDrawData(const DrawingInfo& drawingInfo);
+    void ReflectUniforms();
+    const GLint CheckUniform(const UniformInfo* info, const bool typeMatches) const;
 
 public:
-    GLuint ID;
+    GLuint ID;  // Program, or program pipeline when ProgramRegistry::IsSeparable
 
     inline Types::UInt& GetVertexBufferID() { return mVertexArrayBuffer;  }
     inline Types::UInt& GetElementArrayBufferID() { return mElementArrayBuffer;  }
 
     Program() {}
-    Program(const char* vertexPath, const char* fragmentPath);
+    Program(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines = ShaderDefines());
     void Use() const;
+
+    /**
+     * @brief Switches to the variant of the shaders built with the given feature defines.
+     *
+     * Variants are built on their first use, waiting for the compiler unless prepared early
+     * enough. Use the program again afterwards, and reset the uniforms: they are per variant.
+     */
+    void SetDefines(const ShaderDefines& defines);
+    // Starts building variants ahead of their first use, all compiling at once when the driver can
+    void PrepareVariants(const std::vector<ShaderDefines>& variants);
+    // Whether SetDefines can switch to the variant without waiting, preparing it if needed
+    inline const bool IsVariantReady(const ShaderDefines& defines) { return mVariants.IsReady(defines); }
+    // Looks the name up in the reflection table, prefer Set with a Uniform handle every frame
     void SetMatrix4f(const char* name, const Types::Matrix44& matrix);
+
+    /**
+     * @brief Sets a uniform of this program, which must be in use.
+     *
+     * The handle is resolved on its first use with this program. Names the program lacks
+     * (uniforms unused by the shaders are optimized out) are ignored; type mismatches are
+     * reported once, then ignored too.
+     */
+    template <typename T>
+    void Set(Uniform<T>& uniform, const T& value)
+    {
+        if (uniform.mProgram != ID)
+        {
+            const UniformRange found = FindUniforms(uniform.mHash);
+            for (size_t i = 0; i < sMaxUniformOwners; ++i)
+            {
+                const UniformInfo* info = found.first + i < found.second ? found.first + i : nullptr;
+                uniform.mLocations[i] = CheckUniform(info, info != nullptr && UniformTraits<T>::Matches(info->type));
+                uniform.mOwners[i] = info != nullptr ? info->program : 0;
+            }
+            uniform.mProgram = ID;
+        }
+        for (size_t i = 0; i < sMaxUniformOwners; ++i)
+        {
+            GLState::SetUniform(uniform.mOwners[i], uniform.mLocations[i], value);
+        }
+    }
+
+    using UniformRange = std::pair<const UniformInfo*, const UniformInfo*>;
+    // Reflected uniforms with the given name hash, one per stage declaring it; empty if the program has none
+    const UniformRange FindUniforms(const std::uint32_t hash) const;
+    // Reflected uniform with the given name hash in its first stage, nullptr if the program has none
+    const UniformInfo* FindUniform(const std::uint32_t hash) const;
+    inline const std::vector<UniformInfo>& GetUniforms() const { return mVariant->uniforms; }
+    // Of the variant in use, see ProgramRegistry::LogTimings for every program
+    inline const ProgramRegistry::Timings& GetTimings() const { return mVariant->timings; }
+    /**
+     * @brief Uploads a texture with its whole mip chain, following its usage.
+     *
+     * Static textures get immutable storage (ARB_texture_storage) of exactly their level count
+     * and a sized internal format; dynamic ones, or every texture without the extension, are
+     * specified level by level and stay mutable.
+     */
     const bool LoadTextureToGL(Types::TextureInfo& texture);
     void LoadAllTexturesToGL();
-    void Draw(const DrawingInfo drawingInfo);
+
+    /**
+     * @brief Draws every range of the frame.
+     *
+     * Ranges are drawn in the given order. Consecutive ranges with the same textures and
+     * transparency are submitted by a single multi-draw, indirect when supported. The vertex
+     * shader reads its model matrix from the shader storage buffer at binding sModelsBinding,
+     * at index drawOffset + gl_DrawID.
+     */
+    void Draw(const DrawingInfo& drawingInfo);
+
+    /**
+     * @brief Allocates the storage of the buffer bound to target.
+     *
+     * Static buffers get immutable storage (ARB_buffer_storage) that only GL copies can change
+     * afterwards; dynamic ones stay mutable, for glBufferSubData or a later resize.
+     *
+     * @param[in] data Initial content, nullptr to leave it undefined.
+     */
+    static void AllocateBuffer(const GLenum target, const size_t bytes, const void* data, const Types::eUsage usage);
+    inline const eSubmission GetSubmission() const { return mSubmission; }
 };
 
 namespace GL
@@ -55,8 +189,6 @@ namespace GL
     const bool CheckCompileStatus(Types::UInt shader);
     const bool CheckLinkStatus(Types::UInt program);
     const Types::UInt CompileShader(const char* code, const Types::UInt type);
-    // Creates shader program. NOTE: shaders are deleted after linking
-    void CreateProgram(Types::UInt programID, const Types::UInt vertexShaderID, const Types::UInt fragmentShaderID);
 } // namespace GL
 
 } // namespace System 
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <initializer_list>
+
+namespace Vision
+{
+namespace System
+{
+namespace ProgramCache
+{
+
+static const char* sCacheExtension = ".vprog";
+
+/**
+ * @brief Hashes the sources of every stage of a program, in order, into its cache key.
+ */
+const std::uint64_t HashSources(std::initializer_list<const char*> sources);
+
+/**
+ * @brief Links a program from the binary cached for its sources, skipping their compilation.
+ *
+ * Files are only taken if they were saved with the same GL vendor, renderer and version; the
+ * driver may still reject the binary, after an update keeping the version string for instance.
+ * Also hints the program to keep its binary retrievable, so when this fails the program can be
+ * linked from source and saved.
+ *
+ * @param[in] program Program object without shaders attached.
+ * @return True if the program is linked, false if it must be linked from source.
+ */
+const bool Load(const GLuint program, const std::uint64_t sourceHash);
+
+/**
+ * @brief Writes the binary of a linked program to the cache, replacing a stale one.
+ *
+ * @return True if the file was written.
+ */
+const bool Save(const GLuint program, const std::uint64_t sourceHash);
+
+// Folder the files go to, created on the first save. "shaders/cache" by default
+void SetDirectory(const char* directory);
+// Disabled, Load always fails and Save writes nothing
+void SetEnabled(const bool enabled);
+// Drivers without binary formats can't cache, GL 4.1 or ARB_get_program_binary
+const bool IsSupported();
+
+} // namespace ProgramCache
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/shaderPreprocessor.h>
+#include <system/include/types.h>
+#include <system/include/uniform.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief Every linked program, shared by all the users of the same stage sources and defines.
+ *
+ * Programs are keyed by the hash of their preprocessed sources, so two users of the same files
+ * and defines, or of different files expanding to the same code, get one program compiled
+ * once. A program is built the first time it is requested: linked from the ProgramCache, or
+ * from the SPIR-V built offline specialized for the defines, or compiled from GLSL and linked,
+ * without waiting for the result. Status is only queried when the program is finished, so
+ * every program requested before then compiles meanwhile, on driver threads with
+ * KHR_parallel_shader_compile. Uniforms are reflected by name, so when a driver reports none
+ * for a program loaded from SPIR-V, it is built from GLSL on finishing and SPIR-V is no longer
+ * tried.
+ *
+ * With separable stages (GL 4.1 or ARB_separate_shader_objects), each stage is its own program,
+ * keyed by its source with only the defines it uses, and requests get a program pipeline
+ * combining two of them. A stage shared by several requests, like one vertex shader under
+ * many fragment shaders or fragment variants, is then compiled and linked once: N + M links
+ * instead of N x M.
+ *
+ * Request and Retain must be paired with a Release; the program is deleted with its last user.
+ */
+class ProgramRegistry
+{
+public:
+    enum class eState
+    {
+        PENDING,    // Compiling and linking
+        READY,
+        FAILED      // Errors were reported, the program is unusable
+    };
+
+    // Time the calling thread spent on a program, in milliseconds
+    struct Timings
+    {
+        double compile = 0.0;   // Preprocessing and compiling or specializing the stages, then waiting for them
+        double link = 0.0;      // Linking or loading the cached binary, then waiting for it
+        double ready = 0.0;     // From the request until its status was known, background compilation included
+    };
+
+    struct Entry
+    {
+        GLuint program = 0;         // 0 for pipelines
+        GLuint pipeline = 0;        // Once both stages are ready
+        Entry* stages[2] = { nullptr, nullptr };    // Separable vertex and fragment programs of a pipeline, retained
+        GLuint shaders[2] = { 0, 0 };   // Vertex and fragment, until linked; 0 when loaded from the cache or not a stage of it
+        std::uint64_t sourceHash = 0;
+        eState state = eState::PENDING;
+        std::string name;                   // Files and defines, for reports
+        std::vector<std::string> files[2];  // Vertex and fragment files by source string number, for errors
+        std::string glsl[2];                // Of the stages loaded from SPIR-V, built instead if their uniforms come without names
+        std::vector<UniformInfo> uniforms;  // Filled by the first Program using it, sorted by hash
+        bool reflected = false;
+        Types::UInt refCount = 0;
+        Timings timings;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    using EntryMap = std::map<std::uint64_t, std::unique_ptr<Entry>>;
+
+private:
+    static ProgramRegistry mInstance;
+
+    EntryMap mEntries;  // By source hash, by the hash of their paths and defines for the ones failing preprocessing
+    bool mSeparable;
+    Types::UInt mLinkCount;
+
+    ProgramRegistry();
+
+    // Separable program of one stage, retained
+    static Entry& RequestStage(const GLenum type, const char* path, const std::string& code, const std::vector<std::string>& files,
+                               const ShaderDefines& defines, const std::chrono::steady_clock::time_point requested);
+    // Compiles the stages with a path, a program of a single one is separable
+    static void Build(Entry& entry, const char* const paths[2], const std::string codes[2], const ShaderDefines& defines);
+    // Compiles the stages with a source and links them, without waiting for either
+    static void CompileAndLink(Entry& entry, const std::string codes[2]);
+    // Uniforms are looked up by name, which drivers may not report for SPIR-V without debug info
+    static const bool HasUniformNames(const GLuint program);
+    static const bool IsCompleted(Entry& entry);
+    // Lets the driver compile on as many threads as it likes, once per context
+    static void EnableParallelCompile();
+
+public:
+    // Program of the sources and defines, retained; it starts building if no one else requested it
+    static Entry& Request(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines);
+    static void Retain(Entry& entry);
+    // Deletes the program with its last user, the entry is gone then
+    static void Release(Entry& entry);
+
+    // Whether the program is built and can be used without stalling on the driver. Never for failed ones
+    static const bool IsReady(Entry& entry);
+    // Waits for the compilation as needed and reports errors, then the state is final
+    static void Finish(Entry& entry);
+
+    /**
+     * @brief Builds the programs requested from now on as separable stages in pipelines, when supported.
+     *
+     * On by default. Programs already requested keep their kind, set it before building any.
+     */
+    static void SetSeparable(const bool separable);
+    static const bool IsSeparable();
+
+    static inline const EntryMap& GetEntries() { return mInstance.mEntries; }
+    // Links from source so far, separable stages included and cache loads not
+    static inline const Types::UInt GetLinkCount() { return mInstance.mLinkCount; }
+    // Timings of every program on stdout, slowest first
+    static void LogTimings();
+};
+
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+
+// Feature defines of a shader variant by name, empty values define it as 1. Sorted, so equal sets make equal keys
+using ShaderDefines = std::map<std::string, std::string>;
+
+namespace ShaderPreprocessor
+{
+
+/**
+ * @brief Expands the includes of a GLSL file and adds the defines of a variant to it.
+ *
+ * Lines `#include "path"` are replaced by the file, resolved from the folder of the including
+ * one; files are expanded once, later includes of the same file are dropped like with
+ * `#pragma once`. Every file gets its own source string number in `#line` directives, so
+ * compile errors point to `files[number]` at the right line. The defines go right after
+ * `#version`, which must start the root file.
+ *
+ * @param[out] code The expanded source.
+ * @param[out] files Paths of the expanded files, by source string number; the root one first.
+ * @return True on success, false if a file is missing or includes itself, code is incomplete then.
+ */
+const bool Process(const char* path, const ShaderDefines& defines, std::string& code, std::vector<std::string>* files = nullptr);
+
+/**
+ * @brief Key naming a set of defines, "NAME=value;" for each, empty for none.
+ */
+const std::string GetKey(const ShaderDefines& defines);
+
+/**
+ * @brief Whether processed code mentions a define beyond the line Process added for it.
+ *
+ * Names are matched as text, so a define also found inside a longer name counts as used.
+ */
+const bool IsDefineUsed(const std::string& code, const std::string& name);
+
+// The defines the processed code uses, the others would not change it
+const ShaderDefines GetUsedDefines(const std::string& code, const ShaderDefines& defines);
+
+} // namespace ShaderPreprocessor
+} // namespace System
+} // namespace Vision
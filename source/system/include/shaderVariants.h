@@ -0,0 +1,53 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/programRegistry.h>
+#include <system/include/shaderPreprocessor.h>
+#include <map>
+#include <string>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief Programs built from one vertex and one fragment file, one per set of feature defines.
+ *
+ * Variants come from the ProgramRegistry, shared with every other user of the same sources,
+ * and are released with this set. A variant is built the first time it is requested, without
+ * waiting for the result; see ProgramRegistry for how. Status is only queried when the variant
+ * is acquired, so every variant requested before then compiles meanwhile. Without parallel
+ * compilation, drivers may still compile in the background, IsReady then waits.
+ */
+class ShaderVariants
+{
+public:
+    using eState = ProgramRegistry::eState;
+    using Variant = ProgramRegistry::Entry;
+
+private:
+    std::string mVertexPath;
+    std::string mFragmentPath;
+    std::map<std::string, Variant*> mVariants;  // By ShaderPreprocessor::GetKey of their defines, retained
+
+public:
+    ShaderVariants();
+    ShaderVariants(const char* vertexPath, const char* fragmentPath);
+    ~ShaderVariants();
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // Starts building the variant if it wasn't yet, without waiting for it
+    Variant& Request(const ShaderDefines& defines);
+    // Whether the variant is built and can be used without stalling on the driver, requesting it if needed. Never for failed ones
+    const bool IsReady(const ShaderDefines& defines);
+    // Built variant, waiting for its compilation as needed. Failed ones are returned too
+    Variant& Acquire(const ShaderDefines& defines);
+
+    inline const size_t GetCount() const { return mVariants.size(); }
+};
+
+} // namespace System
+} // namespace Vision
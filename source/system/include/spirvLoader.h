@@ -0,0 +1,46 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/shaderPreprocessor.h>
+#include <system/include/types.h>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+namespace SpirvLoader
+{
+
+static const char* sSpirvDirectory = "spirv";   // Next to the GLSL files, filled by shaders/compileSpirv.bat
+static const char* sSpirvExtension = ".spv";
+
+/**
+ * @brief SPIR-V built offline from a GLSL file, if it is there.
+ *
+ * @return shaders/spirv/default_vs.spv for shaders/default_vs.glsl.
+ */
+const std::string GetBinaryPath(const char* sourcePath);
+
+/**
+ * @brief Creates a shader from the SPIR-V of a GLSL file, specialized for the defines of a variant.
+ *
+ * Defines the stage uses must name a specialization constant, declared in the GLSL as
+ * `layout (constant_id = N) const type NAME` under `#ifdef GL_SPIRV`; empty values set it to 1.
+ * Nothing is done when the driver lacks ARB_gl_spirv, the binary is missing or older than any
+ * of the files expanded into the source, or a define has no constant: the GLSL is compiled then.
+ *
+ * @param[in] code The preprocessed GLSL, where the constants are looked up.
+ * @param[in] files The files expanded into it, see ShaderPreprocessor::Process.
+ * @return The specialized shader, 0 if the GLSL must be used.
+ */
+const GLuint LoadShader(const char* sourcePath, const GLenum type, const std::string& code, const std::vector<std::string>& files, const ShaderDefines& defines);
+
+// Disabled, LoadShader always returns 0
+void SetEnabled(const bool enabled);
+const bool IsSupported();
+
+} // namespace SpirvLoader
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief GL buffer for data written by the CPU every frame, split in one region per frame in flight.
+ *
+ * With ARB_buffer_storage the buffer is created once with glBufferStorage and stays mapped
+ * (persistent and coherent), so allocations are written in place. A fence is placed on a region
+ * when the frame that wrote it ends and waited for before the region is reused, which only
+ * blocks when the CPU gets sRegions frames ahead of the GPU. Frames are the ones counted by
+ * FrameStats::EndFrame.
+ *
+ * Without buffer storage, allocations point to CPU memory uploaded by Commit.
+ */
+class StreamBuffer
+{
+public:
+    struct Allocation
+    {
+        std::uint8_t* data = nullptr;   // Where to write the bytes
+        GLintptr offset = 0;            // Offset of the bytes inside GetBuffer
+        GLsizeiptr size = 0;
+    };
+
+private:
+    static const std::uint32_t sRegions = 3;
+
+    struct Retired
+    {
+        GLuint buffer;
+        bool mapped;
+        size_t frame;       // Frame it was replaced in
+    };
+
+    GLuint mBuffer;
+    size_t mRegionSize;
+    std::uint32_t mRegion;
+    size_t mHead;           // Next free byte of the current region
+    size_t mCommitted;      // Bytes of the current region already uploaded, without buffer storage
+    size_t mFrame;          // Frame the current region belongs to
+    std::uint8_t* mMapped;
+    GLsync mFences[sRegions];
+    std::vector<std::uint8_t> mStaging;
+    std::vector<Retired> mRetired;
+
+    void Advance();
+    void Reallocate(const size_t regionSize);
+    void ReleaseRetired(const bool all);
+
+public:
+    StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+    ~StreamBuffer();
+
+    /**
+     * @brief Creates the buffer, needs a GL context.
+     *
+     * @param[in] regionSize Bytes a frame can write before the buffer has to grow.
+     */
+    void Create(const size_t regionSize);
+    void Destroy();
+
+    /**
+     * @brief Reserves bytes in the region of the current frame.
+     *
+     * A region too small for the frame makes the whole buffer grow, which replaces GetBuffer;
+     * the replaced one is deleted once the GPU can't be using it anymore.
+     *
+     * @param[in] alignment Alignment of the offset, a power of two.
+     */
+    const Allocation Allocate(const size_t bytes, const size_t alignment = 4);
+
+    /**
+     * @brief Makes the bytes written so far visible to GL, nothing to do with buffer storage.
+     */
+    void Commit();
+
+    inline const GLuint GetBuffer() const { return mBuffer; }
+    inline const bool IsPersistent() const { return mMapped != nullptr; }
+};
+
+} // namespace System
+} // namespace Vision
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <common/include/common.h>
 #include <thirdparty/include/thirdparty.h>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace Vision
@@ -10,6 +13,7 @@ namespace System
 namespace Types
 {
 
+typedef glm::vec2 Vector2;
 typedef glm::vec3 Vector3;
 typedef glm::vec4 Vector4;
 typedef glm::mat4 Matrix44;
@@ -106,6 +110,29 @@ struct VertexData : IVertexData
     }
 };
 
+// Pixel layout of the cooked levels of a texture
+enum class eTextureFormat : std::uint32_t
+{
+    RGBA8 = 0,  // 4 bytes per texel
+    BC1 = 1,    // 4x4 blocks of 8 bytes, opaque RGB
+    BC3 = 2,    // 4x4 blocks of 16 bytes, RGB plus interpolated alpha
+    BC7 = 3     // 4x4 blocks of 16 bytes, high quality RGBA
+};
+
+// How a GL resource changes once created
+enum class eUsage
+{
+    STATIC,     // Immutable storage, filled once, only changed by GL copies afterwards
+    DYNAMIC     // Mutable storage, can be respecified or resized
+};
+
+struct TextureLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> data;
+};
+
 struct TextureInfo
 {
     GLuint id;
@@ -113,6 +140,13 @@ struct TextureInfo
     int height;
     int nrChannels;
     unsigned char* data;
+    std::string name;           // Key of this texture in the TextureLoader
+    std::uint64_t contentHash;  // Hash of the decoded pixels, 0 if nothing was decoded
+    UInt refCount;              // Number of users sharing this texture
+    bool srgb;                  // Whether the color channels are sRGB encoded
+    std::vector<TextureLevel> levels;   // Cooked mip chain, replaces data once filled
+    eTextureFormat format;      // Layout of the cooked levels
+    eUsage usage;               // Storage chosen when uploaded
 
     TextureInfo()
         : data(NULL)
@@ -120,8 +154,19 @@ struct TextureInfo
         , height(0)
         , width(0)
         , id(0)
+        , name()
+        , contentHash(0)
+        , refCount(0)
+        , srgb(false)
+        , levels()
+        , format(eTextureFormat::RGBA8)
+        , usage(eUsage::STATIC)
     {}
 
+    // Owns the decoded pixels, so it can only be shared by reference.
+    TextureInfo(const TextureInfo&) = delete;
+    TextureInfo& operator=(const TextureInfo&) = delete;
+
     TextureInfo(const char* path)
         : TextureInfo()
     {
@@ -137,7 +182,10 @@ struct TextureInfo
 
     ~TextureInfo() { stbi_image_free(data); }
 
-    const bool CheckInfo() const { return data != NULL; }
+    const bool CheckInfo() const { return data != NULL || !levels.empty(); }
+    const bool IsCooked() const { return !levels.empty(); }
+    const bool IsUploaded() const { return id != 0 && id != static_cast<GLuint>(-1); }
+    const size_t GetByteSize() const { return static_cast<size_t>(width) * height * nrChannels; }
 };
 
 }//namespace Types
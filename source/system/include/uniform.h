@@ -0,0 +1,109 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <string>
+
+namespace Vision
+{
+namespace System
+{
+
+// Active uniform of a linked program, as reflected at link time
+struct UniformInfo
+{
+    std::uint32_t hash = 0;     // Util::HashString of the name, array names without "[0]"
+    GLint location = -1;
+    GLenum type = 0;
+    GLint arraySize = 1;
+    GLuint program = 0;         // Owner, the stage program using it when stages are separable
+    std::string name;
+};
+
+// Programs a uniform can be set in at once: both stages of a pipeline declaring it
+static const size_t sMaxUniformOwners = 2;
+
+/**
+ * @brief True for the opaque GLSL types set through an int: samplers and images.
+ */
+inline const bool IsSamplerType(const GLenum type)
+{
+    return (type >= GL_SAMPLER_1D && type <= GL_SAMPLER_2D_RECT_SHADOW)
+        || (type >= GL_SAMPLER_1D_ARRAY && type <= GL_UNSIGNED_INT_SAMPLER_BUFFER)
+        || (type >= GL_SAMPLER_CUBE_MAP_ARRAY && type <= GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY)
+        || (type >= GL_IMAGE_1D && type <= GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY)
+        || (type >= GL_SAMPLER_2D_MULTISAMPLE && type <= GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY);
+}
+
+/**
+ * @brief GLSL type and upload call of every C++ type a uniform can be set from.
+ */
+template <typename T>
+struct UniformTraits;
+
+// UploadTo sets a program not in use, ARB_separate_shader_objects (core since GL 4.1)
+#define UNIFORM_TRAITS(cppType, glType, upload, uploadTo)\
+template <>\
+struct UniformTraits<cppType>\
+{\
+    static inline const bool Matches(const GLenum type) { return type == glType; }\
+    static inline void Upload(const GLint location, const cppType& value) { upload; }\
+    static inline void UploadTo(const GLuint program, const GLint location, const cppType& value) { uploadTo; }\
+};
+
+UNIFORM_TRAITS(GLfloat, GL_FLOAT, glUniform1f(location, value), glProgramUniform1f(program, location, value))
+UNIFORM_TRAITS(glm::vec2, GL_FLOAT_VEC2, glUniform2fv(location, 1, glm::value_ptr(value)), glProgramUniform2fv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::vec3, GL_FLOAT_VEC3, glUniform3fv(location, 1, glm::value_ptr(value)), glProgramUniform3fv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::vec4, GL_FLOAT_VEC4, glUniform4fv(location, 1, glm::value_ptr(value)), glProgramUniform4fv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::ivec2, GL_INT_VEC2, glUniform2iv(location, 1, glm::value_ptr(value)), glProgramUniform2iv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::ivec3, GL_INT_VEC3, glUniform3iv(location, 1, glm::value_ptr(value)), glProgramUniform3iv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::ivec4, GL_INT_VEC4, glUniform4iv(location, 1, glm::value_ptr(value)), glProgramUniform4iv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(GLuint, GL_UNSIGNED_INT, glUniform1ui(location, value), glProgramUniform1ui(program, location, value))
+UNIFORM_TRAITS(glm::uvec2, GL_UNSIGNED_INT_VEC2, glUniform2uiv(location, 1, glm::value_ptr(value)), glProgramUniform2uiv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::uvec3, GL_UNSIGNED_INT_VEC3, glUniform3uiv(location, 1, glm::value_ptr(value)), glProgramUniform3uiv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::uvec4, GL_UNSIGNED_INT_VEC4, glUniform4uiv(location, 1, glm::value_ptr(value)), glProgramUniform4uiv(program, location, 1, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::mat2, GL_FLOAT_MAT2, glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value)), glProgramUniformMatrix2fv(program, location, 1, GL_FALSE, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::mat3, GL_FLOAT_MAT3, glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)), glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, glm::value_ptr(value)))
+UNIFORM_TRAITS(glm::mat4, GL_FLOAT_MAT4, glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)), glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value)))
+
+#undef UNIFORM_TRAITS
+
+// int also sets bools, samplers and images
+template <>
+struct UniformTraits<GLint>
+{
+    static inline const bool Matches(const GLenum type) { return type == GL_INT || type == GL_BOOL || IsSamplerType(type); }
+    static inline void Upload(const GLint location, const GLint& value) { glUniform1i(location, value); }
+    static inline void UploadTo(const GLuint program, const GLint location, const GLint& value) { glProgramUniform1i(program, location, value); }
+};
+
+/**
+ * @brief Typed handle of a uniform, named by a hash computed at compile time.
+ *
+ * Resolved against the reflection table of a Program on first use, and again only if used
+ * with another program; setting it never looks up a string. In a pipeline, it is resolved
+ * in every stage declaring it, and set in all of them.
+ */
+template <typename T>
+class Uniform
+{
+    friend class Program;
+
+    std::uint32_t mHash;
+    GLuint mProgram = 0;    // Program it was resolved for, 0 if none
+    GLuint mOwners[sMaxUniformOwners] = { 0, 0 };       // Programs holding the locations, the stages using it when the program is a pipeline
+    GLint mLocations[sMaxUniformOwners] = { -1, -1 };   // -1 if the owner has no such uniform of type T
+
+public:
+    constexpr Uniform(const char* name)
+        : mHash(Util::HashString(name))
+    {}
+
+    constexpr std::uint32_t GetHash() const { return mHash; }
+    // In the first stage using it
+    inline const GLint GetLocation() const { return mLocations[0]; }
+};
+
+} // namespace System
+} // namespace Vision
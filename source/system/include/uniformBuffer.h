@@ -0,0 +1,190 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <system/include/glState.h>
+#include <system/include/streamBuffer.h>
+#include <system/include/types.h>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+
+/**
+ * @brief std140 alignment, size and GLSL name of the C++ types a uniform block can hold.
+ */
+template <typename T>
+struct Std140Traits;
+
+#define STD140_TRAITS(cppType, glslName, alignment, size)\
+template <>\
+struct Std140Traits<cppType>\
+{\
+    static const std::uint32_t sAlignment = alignment;\
+    static const std::uint32_t sSize = size;\
+    static inline const char* GetName() { return glslName; }\
+    static inline void Pack(const cppType& value, std::uint8_t* destination) { std::memcpy(destination, &value, sizeof(value)); }\
+};
+
+STD140_TRAITS(GLfloat, "float", 4, 4)
+STD140_TRAITS(GLint, "int", 4, 4)
+STD140_TRAITS(GLuint, "uint", 4, 4)
+STD140_TRAITS(glm::vec2, "vec2", 8, 8)
+STD140_TRAITS(glm::vec3, "vec3", 16, 12)
+STD140_TRAITS(glm::vec4, "vec4", 16, 16)
+STD140_TRAITS(glm::ivec2, "ivec2", 8, 8)
+STD140_TRAITS(glm::ivec4, "ivec4", 16, 16)
+STD140_TRAITS(glm::mat4, "mat4", 16, 64)
+
+#undef STD140_TRAITS
+
+// Every column of a mat3 takes a vec4
+template <>
+struct Std140Traits<glm::mat3>
+{
+    static const std::uint32_t sAlignment = 16;
+    static const std::uint32_t sSize = 48;
+    static inline const char* GetName() { return "mat3"; }
+    static inline void Pack(const glm::mat3& value, std::uint8_t* destination)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            std::memcpy(destination + column * 16, glm::value_ptr(value[column]), sizeof(glm::vec3));
+        }
+    }
+};
+
+// Member of a uniform block, placed by the std140 rules
+struct Std140Field
+{
+    std::string name;
+    std::string glslType;
+    std::uint32_t offset = 0;
+};
+
+/**
+ * @brief std140 layout of a uniform block, generated from the members of a C++ struct.
+ *
+ * The struct keeps its natural C++ layout; Pack copies every member to its std140 offset.
+ */
+template <typename Struct>
+class Std140Layout
+{
+    using Packer = std::function<void(const Struct&, std::uint8_t*)>;
+
+    std::vector<Std140Field> mFields;
+    std::vector<Packer> mPackers;
+    std::uint32_t mEnd = 0;
+
+public:
+    /**
+     * @brief Appends a member to the block, after the previous one.
+     *
+     * @param[in] name Name of the member in GLSL.
+     * @param[in] member The member of Struct holding the value.
+     */
+    template <typename T>
+    Std140Layout& Add(const char* name, T Struct::* member)
+    {
+        using Traits = Std140Traits<T>;
+
+        const std::uint32_t offset = (mEnd + Traits::sAlignment - 1) & ~(Traits::sAlignment - 1);
+        mFields.push_back({ name, Traits::GetName(), offset });
+        mPackers.push_back([member, offset](const Struct& data, std::uint8_t* block) { Traits::Pack(data.*member, block + offset); });
+        mEnd = offset + Traits::sSize;
+        return *this;
+    }
+
+    // Writes every member to its offset, padding is left untouched
+    void Pack(const Struct& data, std::uint8_t* block) const
+    {
+        for (const Packer& packer : mPackers)
+        {
+            packer(data, block);
+        }
+    }
+
+    // Size of the block, rounded up to a vec4 like GL does
+    inline const std::uint32_t GetSize() const { return (mEnd + 15) & ~15u; }
+    inline const std::vector<Std140Field>& GetFields() const { return mFields; }
+};
+
+/**
+ * @brief GLSL declaration of a block with the given fields.
+ */
+const std::string GetBlockDeclaration(const char* blockName, const GLuint binding, const std::vector<Std140Field>& fields);
+
+/**
+ * @brief Checks a block of a linked program against a layout and assigns its binding point.
+ *
+ * @return False if the program declares the block with other members or offsets; true if it
+ *         matches or doesn't use the block.
+ */
+const bool CheckUniformBlock(const GLuint program, const char* blockName, const GLuint binding, const std::vector<Std140Field>& fields);
+
+/**
+ * @brief Uniform block shared by every program, filled from a C++ struct once per frame.
+ *
+ * Every update is written to a new StreamBuffer allocation and bound with glBindBufferRange,
+ * so the GPU can still read the copies of the frames in flight.
+ */
+template <typename Struct>
+class UniformBuffer
+{
+    const Std140Layout<Struct>& mLayout;
+    StreamBuffer mStream;
+    GLuint mBinding;
+    size_t mAlignment;
+
+public:
+    UniformBuffer(const Std140Layout<Struct>& layout, const GLuint binding)
+        : mLayout(layout)
+        , mStream()
+        , mBinding(binding)
+        , mAlignment(256)
+    {}
+
+    // Needs a GL context
+    void Create()
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        mAlignment = static_cast<size_t>(alignment);
+
+        // A few updates per frame fit before the stream grows
+        const size_t blockSize = (mLayout.GetSize() + mAlignment - 1) / mAlignment * mAlignment;
+        mStream.Create(blockSize * 4);
+    }
+
+    void Update(const Struct& data)
+    {
+        const StreamBuffer::Allocation block = mStream.Allocate(mLayout.GetSize(), mAlignment);
+        mLayout.Pack(data, block.data);
+        mStream.Commit();
+        GLState::BindBufferRange(GL_UNIFORM_BUFFER, mBinding, mStream.GetBuffer(), block.offset, block.size);
+    }
+};
+
+/**
+ * @brief Per-frame and per-view data of every program, block "Frame".
+ */
+struct FrameUniforms
+{
+    static const GLuint sBinding = 0;
+    static constexpr const char* sBlockName = "Frame";
+
+    Types::Matrix44 view = Types::Matrix44(1.0f);
+    Types::Matrix44 projection = Types::Matrix44(1.0f);
+    Types::Matrix44 viewProjection = Types::Matrix44(1.0f);
+    Types::Vector3 cameraPosition = Types::Vector3(0.0f);
+
+    static const Std140Layout<FrameUniforms>& GetLayout();
+};
+
+} // namespace System
+} // namespace Vision
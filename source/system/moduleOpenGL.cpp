@@ -1,8 +1,16 @@
 #include "include/moduleOpenGL.h"
 
 #include <common/include/common.h>
+#include <system/include/frameStats.h>
+#include <system/include/glState.h>
+#include <system/include/uniformBuffer.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <graphic/include/blockCompression.h>
 #include <graphic/include/graphic.h>
+#include <graphic/include/mipmap.h>
+#include <graphic/include/pixelFormat.h>
 #include <iostream>
 #include <thirdparty/include/thirdparty.h>
 
@@ -11,86 +19,65 @@ namespace Vision
 namespace System
 {
 
-//********************************
-//     Class Program
-//********************************
-//----------------------------------------------------------------
-Program::Program(const char* vertexPath, const char* fragmentPath)
-{
-    Util::FileString code(vertexPath);
-    GLuint vertexID = CompileShader(code.c_str(), GL_VERTEX_SHADER);
-    code.ChangeFile(fragmentPath);
-    GLuint fragmentID = CompileShader(code.c_str(), GL_FRAGMENT_SHADER);
+static const size_t sDrawStreamRegionBytes = 1024 * 1024;  // Draw data of a frame before the stream grows
 
-    LinkProgram(vertexID, fragmentID);
-    CleanShaders(vertexID, fragmentID);
-
-    GenerateBuffers();
-}
-
-//----------------------------------------------------------------
-const GLuint Program::CompileShader(const char* code, const GLuint type)
+// Immutable textures have every level allocated up front, levels are only filled here
+static void UploadLevel(const bool immutable, const GLint level, const GLenum internalFormat, const int width, const int height,
+                        const GLenum format, const GLenum type, const void* pixels)
 {
-    GLuint id = glCreateShader(type);
-    glShaderSource(id, 1, &code, NULL);
-    glCompileShader(id);
-    CheckErrors(id, true);
-    return id;
+    if (immutable)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, type, pixels);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, pixels);
+    }
 }
 
+//********************************
+//     Class Program
+//********************************
 //----------------------------------------------------------------
-void Program::LinkProgram(const GLuint vertexID, const GLuint fragmentID)
+Program::Program(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines /*= ShaderDefines()*/)
+    : mVariants(vertexPath, fragmentPath)
 {
-    ID = glCreateProgram();
-    glAttachShader(ID, vertexID);
-    glAttachShader(ID, fragmentID);
-    glLinkProgram(ID);
-    CheckErrors(ID, false);
+    SetDefines(defines);
+    GenerateBuffers();
 }
 
 //----------------------------------------------------------------
-void Program::CheckErrors(GLuint shader, const bool isShader)
+void Program::SetDefines(const ShaderDefines& defines)
 {
-    GLint success;
-    GLchar infoLog[1024];
-    if (isShader)
-    {
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            LOG_STDERR(" Shader compilation error: " << infoLog);
-        }
-    }
-    else
+    mVariant = &mVariants.Acquire(defines);
+    ID = mVariant->pipeline != 0 ? mVariant->pipeline : mVariant->program;
+    if (!mVariant->reflected)
     {
-        glGetProgramiv(shader, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-            LOG_STDERR("Linking error: " << infoLog);
-        }
+        mVariant->reflected = true;
+        ReflectUniforms();
     }
 }
 
 //----------------------------------------------------------------
-void Program::CleanShaders(const GLuint vertexID, const GLuint fragmentID)
+void Program::PrepareVariants(const std::vector<ShaderDefines>& variants)
 {
-    glDeleteShader(vertexID);
-    glDeleteShader(fragmentID);
+    for (const ShaderDefines& defines : variants)
+    {
+        mVariants.Request(defines);
+    }
 }
 
 //----------------------------------------------------------------
 void Program::GenerateBuffers()
 {
     glGenVertexArrays(1, &mVertexArrayObject);
-    glBindVertexArray(mVertexArrayObject);
+    GLState::BindVertexArray(mVertexArrayObject);
 
     glGenBuffers(1, &mVertexArrayBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, mVertexArrayBuffer);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, mVertexArrayBuffer);
 
     glGenBuffers(1, &mElementArrayBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementArrayBuffer);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementArrayBuffer);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, false, Types::VertexConst::sStrideSize, (void*)Types::VertexConst::sPointPointer);
     glEnableVertexAttribArray(0);
@@ -98,50 +85,405 @@ void Program::GenerateBuffers()
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(2, 2, GL_FLOAT, false, Types::VertexConst::sStrideSize, (void*)Types::VertexConst::sTexturePointer);
     glEnableVertexAttribArray(2);
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    mStorageAlignment = static_cast<size_t>(alignment);
+    mCommandsOffset = 0;
+    mDrawStream.Create(sDrawStreamRegionBytes);
+
+    mSubmission = GLAD_GL_ARB_multi_draw_indirect != 0 ? eSubmission::MULTI_DRAW_INDIRECT : eSubmission::MULTI_DRAW;
+}
+
+//----------------------------------------------------------------
+void Program::UploadDrawData(const DrawingInfo& drawingInfo)
+{
+    assert(drawingInfo.models.size() == drawingInfo.ranges.size());
+    const size_t drawCount = drawingInfo.ranges.size();
+
+    // Written straight into the stream, in a region the GPU is done with. One allocation for
+    // all, so growing the stream can't leave them in different buffers. The fades are bound
+    // as storage too, so they start aligned like the models.
+    const bool indirect = mSubmission == eSubmission::MULTI_DRAW_INDIRECT;
+    const size_t modelBytes = drawCount * sizeof(Types::Matrix44);
+    const size_t fadeOffset = (modelBytes + mStorageAlignment - 1) & ~(mStorageAlignment - 1);
+    const size_t fadeBytes = drawCount * sizeof(float);
+    const size_t commandOffset = fadeOffset + fadeBytes;
+    const size_t commandBytes = indirect ? drawCount * sizeof(DrawElementsIndirectCommand) : 0;
+    const StreamBuffer::Allocation data = mDrawStream.Allocate(commandOffset + commandBytes, mStorageAlignment);
+    std::memcpy(data.data, drawingInfo.models.data(), modelBytes);
+
+    float* fade = reinterpret_cast<float*>(data.data + fadeOffset);
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        fade[i] = drawingInfo.ranges[i].fade;
+    }
+
+    if (indirect)
+    {
+        DrawElementsIndirectCommand* command = reinterpret_cast<DrawElementsIndirectCommand*>(data.data + commandOffset);
+        for (size_t i = 0; i < drawCount; ++i, ++command)
+        {
+            const DrawRange& range = drawingInfo.ranges[i];
+            *command = DrawElementsIndirectCommand();
+            command->count = range.indexCount;
+            command->firstIndex = range.firstIndex;
+            command->baseVertex = range.baseVertex;
+        }
+    }
+    mDrawStream.Commit();
+
+    GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, sModelsBinding, mDrawStream.GetBuffer(), data.offset, modelBytes);
+    GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, sFadesBinding, mDrawStream.GetBuffer(), data.offset + fadeOffset, fadeBytes);
+    if (indirect)
+    {
+        GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, mDrawStream.GetBuffer());
+        mCommandsOffset = data.offset + commandOffset;
+    }
+    else
+    {
+        mCounts.resize(drawCount);
+        mIndexOffsets.resize(drawCount);
+        mBaseVertices.resize(drawCount);
+        for (size_t i = 0; i < drawCount; ++i)
+        {
+            const DrawRange& range = drawingInfo.ranges[i];
+            mCounts[i] = static_cast<GLsizei>(range.indexCount);
+            mIndexOffsets[i] = reinterpret_cast<const void*>(range.firstIndex * Types::VertexConst::sIndexElementBytes);
+            mBaseVertices[i] = range.baseVertex;
+        }
+    }
 }
 
 //----------------------------------------------------------------
 void Program::Use() const
 {
-    glUseProgram(ID);
+    // A program in use takes over the bound pipeline
+    if (mVariant != nullptr && mVariant->pipeline != 0)
+    {
+        GLState::UseProgram(0);
+        GLState::BindProgramPipeline(mVariant->pipeline);
+    }
+    else
+    {
+        GLState::UseProgram(ID);
+    }
 }
 
 //----------------------------------------------------------------
-void Program::Draw(const DrawingInfo drawingInfo)
+void Program::Draw(const DrawingInfo& drawingInfo)
 {
     glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     //NOTE: Set the buffers in the scenario
 
-    glBindVertexArray(mVertexArrayObject);
-    glDrawElements(drawingInfo.drawType, drawingInfo.indexCount, GL_UNSIGNED_INT, 0);
+    const size_t drawCount = drawingInfo.ranges.size();
+    if (drawCount == 0)
+    {
+        return;
+    }
+
+    // Every mesh lives in the same buffers, one VAO serves the whole frame
+    GLState::BindVertexArray(mVertexArrayObject);
+    UploadDrawData(drawingInfo);
+
+    // State can't change inside a multi-draw, so each run of ranges sharing it is one command
+    size_t first = 0;
+    while (first < drawCount)
+    {
+        const Graphic::GraphicData* textures = drawingInfo.ranges[first].graphicData;
+        const bool transparent = drawingInfo.ranges[first].transparent;
+        size_t last = first + 1;
+        while (last < drawCount)
+        {
+            const Graphic::GraphicData* next = drawingInfo.ranges[last].graphicData;
+            const bool same = textures == nullptr || next == nullptr ? textures == next : textures->HasSameTextures(*next);
+            if (!same || drawingInfo.ranges[last].transparent != transparent)
+            {
+                break;
+            }
+            ++last;
+        }
+
+        if (textures != nullptr)
+        {
+            textures->BindTextures();
+        }
+
+        // Set per run, GLState drops the calls that change nothing
+        GLState::SetEnabled(GL_BLEND, transparent);
+        if (transparent)
+        {
+            GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        GLState::DepthMask(!transparent);
+
+        // gl_DrawID restarts at 0 in every command
+        Set(mDrawOffset, static_cast<GLint>(first));
+        const GLsizei count = static_cast<GLsizei>(last - first);
+        if (mSubmission == eSubmission::MULTI_DRAW_INDIRECT)
+        {
+            const void* commands = reinterpret_cast<const void*>(mCommandsOffset + first * sizeof(DrawElementsIndirectCommand));
+            glMultiDrawElementsIndirect(drawingInfo.drawType, GL_UNSIGNED_INT, commands, count, 0);
+        }
+        else
+        {
+            glMultiDrawElementsBaseVertex(drawingInfo.drawType, &mCounts[first], GL_UNSIGNED_INT, &mIndexOffsets[first], count, &mBaseVertices[first]);
+        }
+        FrameStats::AddDrawCall(count);
+
+        first = last;
+    }
+
+    GLState::SetEnabled(GL_BLEND, false);
+    GLState::DepthMask(true);
 }
 
 //----------------------------------------------------------------
 void Program::SetMatrix4f(const char* name, const Types::Matrix44& matrix)
 {
-    const GLuint location = glGetUniformLocation(ID, name);
-    assert(location != -1);
+    const UniformRange found = FindUniforms(Util::HashString(name));
+    assert(found.first != found.second);
+
+    for (const UniformInfo* info = found.first; info != found.second; ++info)
+    {
+        GLState::SetUniform(info->program, info->location, matrix);
+    }
+}
+
+//----------------------------------------------------------------
+void Program::ReflectUniforms()
+{
+    std::vector<UniformInfo>& uniforms = mVariant->uniforms;
+    uniforms.clear();
+
+    // A pipeline has the uniforms of its stages, each set in its own program
+    const bool pipeline = mVariant->stages[0] != nullptr;
+    const GLuint programs[2] = { pipeline ? mVariant->stages[0]->program : ID, pipeline ? mVariant->stages[1]->program : 0 };
+    for (const GLuint program : programs)
+    {
+        if (program == 0)
+        {
+            continue;
+        }
+        CheckUniformBlock(program, FrameUniforms::sBlockName, FrameUniforms::sBinding, FrameUniforms::GetLayout().GetFields());
+
+        GLint count = 0;
+        if (GLAD_GL_ARB_program_interface_query)
+        {
+            glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+        }
+        else
+        {
+            glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        }
+
+        GLchar name[256];
+        for (GLint i = 0; i < count; ++i)
+        {
+            UniformInfo info;
+            if (GLAD_GL_ARB_program_interface_query)
+            {
+                const GLenum properties[] = { GL_BLOCK_INDEX, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+                GLint values[4];
+                static_assert(sizeof(values) / sizeof(GLint) == sizeof(properties) / sizeof(GLenum), "One value per property");
+                glGetProgramResourceiv(program, GL_UNIFORM, i, Util::RawArraySize(properties), properties, Util::RawArraySize(values), nullptr, values);
+                if (values[0] != -1)
+                {
+                    continue; // Member of a uniform block, it has no location
+                }
+
+                info.type = values[1];
+                info.location = values[2];
+                info.arraySize = values[3];
+                glGetProgramResourceName(program, GL_UNIFORM, i, sizeof(name), nullptr, name);
+            }
+            else
+            {
+                GLint arraySize = 0;
+                glGetActiveUniform(program, i, sizeof(name), nullptr, &arraySize, &info.type, name);
+                info.location = glGetUniformLocation(program, name);
+                info.arraySize = arraySize;
+                if (info.location == -1)
+                {
+                    continue;
+                }
+            }
+
+            // Arrays are reported as their first element
+            info.name = name;
+            const size_t bracket = info.name.find('[');
+            if (bracket != std::string::npos)
+            {
+                info.name.resize(bracket);
+            }
+            info.hash = Util::HashString(info.name.c_str());
+            info.program = program;
+            uniforms.push_back(info);
+        }
+    }
+
+    // Uniforms declared by both stages stay together, one per stage, and are set in both
+    std::stable_sort(uniforms.begin(), uniforms.end(), [](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+    size_t first = 0;   // Of the uniforms with the hash of the current one
+    for (size_t i = 1; i < uniforms.size();)
+    {
+        if (uniforms[i].hash != uniforms[first].hash)
+        {
+            first = i++;
+        }
+        else if (uniforms[i].name != uniforms[first].name)
+        {
+            LOG_STDERR("Uniforms " << uniforms[first].name << " and " << uniforms[i].name << " have the same hash, rename one of them");
+            uniforms.erase(uniforms.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const UniformInfo* Program::FindUniform(const std::uint32_t hash) const
+{
+    const UniformRange found = FindUniforms(hash);
+    return found.first != found.second ? found.first : nullptr;
+}
+
+//----------------------------------------------------------------
+const Program::UniformRange Program::FindUniforms(const std::uint32_t hash) const
+{
+    if (mVariant == nullptr || mVariant->uniforms.empty())
+    {
+        return UniformRange(nullptr, nullptr);
+    }
+    const std::vector<UniformInfo>& uniforms = mVariant->uniforms;
+    struct ByHash
+    {
+        bool operator()(const UniformInfo& info, const std::uint32_t value) const { return info.hash < value; }
+        bool operator()(const std::uint32_t value, const UniformInfo& info) const { return value < info.hash; }
+    };
+    auto found = std::equal_range(uniforms.begin(), uniforms.end(), hash, ByHash());
+    return UniformRange(uniforms.data() + (found.first - uniforms.begin()), uniforms.data() + (found.second - uniforms.begin()));
+}
 
-    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(matrix));
+//----------------------------------------------------------------
+const GLint Program::CheckUniform(const UniformInfo* info, const bool typeMatches) const
+{
+    if (info == nullptr)
+    {
+        // Uniforms unused by the shaders are optimized out, which is not an error
+        return -1;
+    }
+    if (!typeMatches)
+    {
+        LOG_STDERR("Uniform " << info->name << " set with a type other than its GLSL type 0x" << std::hex << info->type << std::dec);
+        return -1;
+    }
+    return info->location;
 }
 
 //----------------------------------------------------------------
 const bool Program::LoadTextureToGL(Types::TextureInfo& texture)
 {
+    // Shared textures are uploaded once for all their users
+    if (texture.IsUploaded())
+    {
+        return true;
+    }
+
     if (texture.CheckInfo())
     {
         glGenTextures(1, &texture.id);
-        glBindTexture(GL_TEXTURE_2D, texture.id);
+        GLState::BindTexture(0, GL_TEXTURE_2D, texture.id);
         // set the texture wrapping parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texture.width, texture.height, 0, GL_RGB, GL_UNSIGNED_BYTE, texture.data);
+        const bool immutable = texture.usage == Types::eUsage::STATIC && GLAD_GL_ARB_texture_storage != 0;
+
+        if (texture.IsCooked())
+        {
+            // Mip chain was built on the CPU, upload every level as is
+            const GLsizei levelCount = static_cast<GLsizei>(texture.levels.size());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+            const bool compressed = texture.format != Types::eTextureFormat::RGBA8;
+            if (compressed && Graphic::BlockCompression::IsSupportedByGL(texture.format, texture.srgb))
+            {
+                const GLenum internalFormat = Graphic::BlockCompression::GetGLFormat(texture.format, texture.srgb);
+                if (immutable)
+                {
+                    glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, texture.width, texture.height);
+                }
+                for (size_t level = 0; level < texture.levels.size(); ++level)
+                {
+                    const Types::TextureLevel& mip = texture.levels.at(level);
+                    const GLsizei size = static_cast<GLsizei>(mip.data.size());
+                    if (immutable)
+                    {
+                        glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, mip.width, mip.height, internalFormat, size, mip.data.data());
+                    }
+                    else
+                    {
+                        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internalFormat, mip.width, mip.height, 0, size, mip.data.data());
+                    }
+                }
+                return true;
+            }
+
+            // Blocks the driver can't sample are decompressed here
+            const Graphic::Pixel::UploadFormat format = Graphic::Pixel::ChooseUploadFormat(4, texture.width, texture.srgb);
+            if (immutable)
+            {
+                glTexStorage2D(GL_TEXTURE_2D, levelCount, format.internalFormat, texture.width, texture.height);
+            }
+            std::vector<unsigned char> decoded;
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // RGBA rows of every level
+            for (size_t level = 0; level < texture.levels.size(); ++level)
+            {
+                const Types::TextureLevel& mip = texture.levels.at(level);
+                const unsigned char* pixels = mip.data.data();
+                if (compressed)
+                {
+                    decoded.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+                    Graphic::BlockCompression::Decode(pixels, mip.width, mip.height, texture.format, decoded.data());
+                    pixels = decoded.data();
+                }
+                UploadLevel(immutable, static_cast<GLint>(level), format.internalFormat, mip.width, mip.height, format.format, format.type, pixels);
+            }
+            return true;
+        }
+
+        const Graphic::Pixel::UploadFormat format = Graphic::Pixel::ChooseUploadFormat(texture.nrChannels, texture.width, texture.srgb);
+        if (format.swizzle)
+        {
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, format.swizzleMask);
+        }
+
+        // Expand to the upload layout when the decoded one can't be used as is
+        const unsigned char* pixels = texture.data;
+        std::vector<unsigned char> converted;
+        if (format.channels != texture.nrChannels)
+        {
+            const size_t pixelCount = static_cast<size_t>(texture.width) * texture.height;
+            converted.resize(pixelCount * format.channels);
+            Graphic::Pixel::ConvertToRGBA(texture.data, texture.nrChannels, converted.data(), pixelCount);
+            pixels = converted.data();
+        }
+
+        // glGenerateMipmap fills the levels allocated by the storage
+        if (immutable)
+        {
+            glTexStorage2D(GL_TEXTURE_2D, Graphic::Mipmap::LevelCount(texture.width, texture.height), format.internalFormat, texture.width, texture.height);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, format.alignment);
+        UploadLevel(immutable, 0, format.internalFormat, texture.width, texture.height, format.format, format.type, pixels);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         return true;
@@ -150,13 +492,27 @@ const bool Program::LoadTextureToGL(Types::TextureInfo& texture)
     return false;
 }
 
+//----------------------------------------------------------------
+void Program::AllocateBuffer(const GLenum target, const size_t bytes, const void* data, const Types::eUsage usage)
+{
+    if (usage == Types::eUsage::STATIC && GLAD_GL_ARB_buffer_storage)
+    {
+        // No flag: the CPU neither maps nor writes it, copies and GPU writes are still allowed
+        glBufferStorage(target, bytes, data, 0);
+    }
+    else
+    {
+        glBufferData(target, bytes, data, usage == Types::eUsage::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+    }
+}
+
 //----------------------------------------------------------------
 void Program::LoadAllTexturesToGL()
 {
     Graphic::TextureMap& texList = Graphic::TextureLoader::GetTextureList();
     for (auto& tex : texList)
     {
-        LoadTextureToGL(tex.second);
+        LoadTextureToGL(*tex.second);
     }
 }
 
@@ -204,19 +560,6 @@ const Types::UInt CompileShader(const char* code, const Types::UInt type)
     return CheckCompileStatus(id) ? id : -1;
 }
 
-//----------------------------------------------------------------
-void CreateProgram(Types::UInt programID, const Types::UInt vertexShaderID, const Types::UInt fragmentShaderID)
-{
-    programID = glCreateProgram();
-    glAttachShader(programID, vertexShaderID);
-    glAttachShader(programID, fragmentShaderID);
-    glLinkProgram(programID);
-    CheckLinkStatus(programID);
-
-    glDeleteShader(vertexShaderID);
-    glDeleteShader(fragmentShaderID);
-}
-
 } // namespace GL
 } // namespace System
 } // namespace Vision
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "include/moduleSDL.h"
 #include <common/include/common.h>
+#include <system/include/glState.h>
 
 namespace Vision
 {
@@ -90,7 +91,8 @@ Window::Window(const int width, const int height, const char* title /* = "New wi
 
             SDL_GL_MakeCurrent(mWindow, glContext);
 
-            glEnable(GL_DEPTH_TEST);
+            GLState::Invalidate();
+            GLState::SetEnabled(GL_DEPTH_TEST, true);
             glViewport(0, 0, 800, 600);
         }
         else
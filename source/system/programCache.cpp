@@ -0,0 +1,188 @@
+#include <system/include/programCache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace System
+{
+namespace ProgramCache
+{
+
+namespace
+{
+    static const std::uint32_t sMagic = 0x47525056; // "VPRG"
+    static const std::uint32_t sVersion = 1;
+
+    struct FileHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t sourceHash;
+        std::uint64_t driverHash;   // Of the GL vendor, renderer and version strings
+        std::uint32_t format;       // Binary format reported by the driver
+        std::uint32_t byteSize;
+    };
+
+    static std::string sDirectory = "shaders/cache";
+    static bool sEnabled = true;
+
+    //----------------------------------------------------------------
+    const std::uint64_t HashDriver()
+    {
+        std::uint64_t hash = Util::sHashSeed;
+        for (const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            const GLubyte* text = glGetString(name);
+            const char* string = text != nullptr ? reinterpret_cast<const char*>(text) : "";
+            hash = Util::HashBytes(string, std::strlen(string) + 1, hash);
+        }
+        return hash;
+    }
+
+    //----------------------------------------------------------------
+    const std::filesystem::path GetPath(const std::uint64_t sourceHash)
+    {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(sourceHash));
+        return std::filesystem::path(sDirectory) / (std::string(name) + sCacheExtension);
+    }
+}
+
+//----------------------------------------------------------------
+const std::uint64_t HashSources(std::initializer_list<const char*> sources)
+{
+    std::uint64_t hash = Util::sHashSeed;
+    for (const char* source : sources)
+    {
+        // Terminating null included, so string boundaries count
+        hash = Util::HashBytes(source, std::strlen(source) + 1, hash);
+    }
+    return hash;
+}
+
+//----------------------------------------------------------------
+const bool Load(const GLuint program, const std::uint64_t sourceHash)
+{
+    if (!sEnabled || !IsSupported())
+    {
+        return false;
+    }
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // Not cached yet
+    const std::filesystem::path path = GetPath(sourceHash);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Saved by another driver or for sources colliding in the name, replaced once linked again
+    FileHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != sMagic || header.version != sVersion || header.sourceHash != sourceHash || header.driverHash != HashDriver())
+    {
+        return false;
+    }
+
+    std::vector<char> binary(header.byteSize);
+    file.read(binary.data(), binary.size());
+    if (!file || binary.empty())
+    {
+        LOG_STDERR("Truncated program binary \'" << path.string() << "\'.");
+        return false;
+    }
+
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        LOG_STDOUT("Program binary \'" << path.string() << "\' rejected by the driver, linking from source.");
+        return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+const bool Save(const GLuint program, const std::uint64_t sourceHash)
+{
+    if (!sEnabled || !IsSupported())
+    {
+        return false;
+    }
+
+    GLint linked = GL_FALSE;
+    GLint length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linked != GL_TRUE || length <= 0)
+    {
+        return false;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+    {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(sDirectory, error);
+    const std::filesystem::path path = GetPath(sourceHash);
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        LOG_STDERR("Failed writing program binary \'" << path.string() << "\'.");
+        return false;
+    }
+
+    FileHeader header = {};
+    header.magic = sMagic;
+    header.version = sVersion;
+    header.sourceHash = sourceHash;
+    header.driverHash = HashDriver();
+    header.format = format;
+    header.byteSize = static_cast<std::uint32_t>(written);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), written);
+
+    return file.good();
+}
+
+//----------------------------------------------------------------
+void SetDirectory(const char* directory)
+{
+    sDirectory = directory;
+}
+
+//----------------------------------------------------------------
+void SetEnabled(const bool enabled)
+{
+    sEnabled = enabled;
+}
+
+//----------------------------------------------------------------
+const bool IsSupported()
+{
+    if (GLAD_GL_VERSION_4_1 == 0 && GLAD_GL_ARB_get_program_binary == 0)
+    {
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+} // namespace ProgramCache
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,473 @@
+#include <system/include/programRegistry.h>
+
+#include <system/include/glState.h>
+#include <system/include/moduleOpenGL.h>
+#include <system/include/programCache.h>
+#include <system/include/spirvLoader.h>
+#include <algorithm>
+
+namespace Vision
+{
+namespace System
+{
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    static const GLenum sStageTypes[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    static const GLbitfield sStageBits[2] = { GL_VERTEX_SHADER_BIT, GL_FRAGMENT_SHADER_BIT };
+
+    //----------------------------------------------------------------
+    inline const double Milliseconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+} // namespace
+
+//********************************
+//     Class ProgramRegistry
+//********************************
+ProgramRegistry ProgramRegistry::mInstance;
+
+//----------------------------------------------------------------
+ProgramRegistry::ProgramRegistry()
+    : mEntries()
+    , mSeparable(true)
+    , mLinkCount(0)
+{}
+
+//----------------------------------------------------------------
+void ProgramRegistry::EnableParallelCompile()
+{
+    static bool enabled = false;
+    if (enabled)
+    {
+        return;
+    }
+    enabled = true;
+
+    if (GLAD_GL_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+}
+
+//----------------------------------------------------------------
+ProgramRegistry::Entry& ProgramRegistry::Request(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines)
+{
+    EnableParallelCompile();
+
+    const Clock::time_point requested = Clock::now();
+    const char* const paths[2] = { vertexPath, fragmentPath };
+    std::unique_ptr<Entry> entry(new Entry());
+    std::string codes[2];
+    bool processed = true;
+    for (int i = 0; i < 2 && processed; ++i)
+    {
+        processed = ShaderPreprocessor::Process(paths[i], defines, codes[i], &entry->files[i]);
+    }
+
+    // Separable stages only get the defines they use, so the variants of one stage share the other
+    const bool separable = processed && IsSeparable();
+    ShaderDefines stageDefines[2] = { defines, defines };
+    for (int i = 0; i < 2 && separable; ++i)
+    {
+        stageDefines[i] = ShaderPreprocessor::GetUsedDefines(codes[i], defines);
+        if (stageDefines[i].size() != defines.size())
+        {
+            processed = processed && ShaderPreprocessor::Process(paths[i], stageDefines[i], codes[i], &entry->files[i]);
+        }
+    }
+
+    // Failed ones are kept too, under their paths and defines
+    const std::string key = ShaderPreprocessor::GetKey(defines);
+    if (!processed)
+    {
+        entry->sourceHash = ProgramCache::HashSources({ vertexPath, fragmentPath, key.c_str() });
+    }
+    else if (separable)
+    {
+        entry->sourceHash = ProgramCache::HashSources({ "pipeline", codes[0].c_str(), codes[1].c_str() });
+    }
+    else
+    {
+        entry->sourceHash = ProgramCache::HashSources({ codes[0].c_str(), codes[1].c_str() });
+    }
+
+    auto found = mInstance.mEntries.find(entry->sourceHash);
+    if (found != mInstance.mEntries.end())
+    {
+        ++found->second->refCount;
+        return *found->second;
+    }
+
+    entry->name = std::string(vertexPath) + " + " + fragmentPath + (key.empty() ? "" : " [" + key + "]");
+    entry->refCount = 1;
+    entry->requested = requested;
+    entry->timings.compile = Milliseconds(requested);
+    if (!processed)
+    {
+        entry->state = eState::FAILED;
+    }
+    else if (separable)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            entry->stages[i] = &RequestStage(sStageTypes[i], paths[i], codes[i], entry->files[i], stageDefines[i], requested);
+        }
+    }
+    else
+    {
+        Build(*entry, paths, codes, defines);
+    }
+
+    Entry& added = *entry;
+    mInstance.mEntries.emplace(added.sourceHash, std::move(entry));
+    return added;
+}
+
+//----------------------------------------------------------------
+ProgramRegistry::Entry& ProgramRegistry::RequestStage(const GLenum type, const char* path, const std::string& code, const std::vector<std::string>& files,
+                                                      const ShaderDefines& defines, const Clock::time_point requested)
+{
+    const std::uint64_t sourceHash = ProgramCache::HashSources({ "separable", code.c_str() });
+    auto found = mInstance.mEntries.find(sourceHash);
+    if (found != mInstance.mEntries.end())
+    {
+        ++found->second->refCount;
+        return *found->second;
+    }
+
+    const int stage = type == GL_VERTEX_SHADER ? 0 : 1;
+    const char* paths[2] = { nullptr, nullptr };
+    std::string codes[2];
+    paths[stage] = path;
+    codes[stage] = code;
+
+    std::unique_ptr<Entry> entry(new Entry());
+    const std::string key = ShaderPreprocessor::GetKey(defines);
+    entry->sourceHash = sourceHash;
+    entry->name = std::string(path) + (key.empty() ? "" : " [" + key + "]");
+    entry->files[stage] = files;
+    entry->refCount = 1;
+    entry->requested = requested;
+    Build(*entry, paths, codes, defines);
+
+    Entry& added = *entry;
+    mInstance.mEntries.emplace(sourceHash, std::move(entry));
+    return added;
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::Build(Entry& entry, const char* const paths[2], const std::string codes[2], const ShaderDefines& defines)
+{
+    Clock::time_point start = Clock::now();
+    entry.program = glCreateProgram();
+    if (paths[0] == nullptr || paths[1] == nullptr)
+    {
+        glProgramParameteri(entry.program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+    const bool cached = ProgramCache::Load(entry.program, entry.sourceHash);
+    entry.timings.link = Milliseconds(start);
+    if (cached)
+    {
+        entry.timings.ready = Milliseconds(entry.requested);
+        entry.state = eState::READY;
+        return;
+    }
+
+    // A program can't mix SPIR-V and GLSL stages, all come from SPIR-V or none
+    start = Clock::now();
+    bool spirv = true;
+    for (int i = 0; i < 2 && spirv; ++i)
+    {
+        if (paths[i] != nullptr)
+        {
+            entry.shaders[i] = SpirvLoader::LoadShader(paths[i], sStageTypes[i], codes[i], entry.files[i], defines);
+            spirv = entry.shaders[i] != 0;
+        }
+    }
+    if (spirv)
+    {
+        entry.glsl[0] = codes[0];
+        entry.glsl[1] = codes[1];
+    }
+    else
+    {
+        for (GLuint& shader : entry.shaders)
+        {
+            glDeleteShader(shader);
+            shader = 0;
+        }
+    }
+    entry.timings.compile += Milliseconds(start);
+
+    CompileAndLink(entry, spirv ? nullptr : codes);
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::CompileAndLink(Entry& entry, const std::string codes[2])
+{
+    // No status query here, it would wait for the compiler
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < 2 && codes != nullptr; ++i)
+    {
+        if (!codes[i].empty())
+        {
+            const char* code = codes[i].c_str();
+            entry.shaders[i] = glCreateShader(sStageTypes[i]);
+            glShaderSource(entry.shaders[i], 1, &code, NULL);
+            glCompileShader(entry.shaders[i]);
+        }
+    }
+    entry.timings.compile += Milliseconds(start);
+
+    start = Clock::now();
+    for (const GLuint shader : entry.shaders)
+    {
+        if (shader != 0)
+        {
+            glAttachShader(entry.program, shader);
+        }
+    }
+    glLinkProgram(entry.program);
+    ++mInstance.mLinkCount;
+    entry.timings.link += Milliseconds(start);
+}
+
+//----------------------------------------------------------------
+const bool ProgramRegistry::HasUniformNames(const GLuint program)
+{
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        GLchar name[2];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+        if (length == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::Finish(Entry& entry)
+{
+    if (entry.state != eState::PENDING)
+    {
+        return;
+    }
+
+    // Pipelines need no link, only their stages
+    if (entry.stages[0] != nullptr)
+    {
+        Finish(*entry.stages[0]);
+        Finish(*entry.stages[1]);
+        const bool ready = entry.stages[0]->state == eState::READY && entry.stages[1]->state == eState::READY;
+        if (ready)
+        {
+            const Clock::time_point start = Clock::now();
+            glGenProgramPipelines(1, &entry.pipeline);
+            for (int i = 0; i < 2; ++i)
+            {
+                glUseProgramStages(entry.pipeline, sStageBits[i], entry.stages[i]->program);
+            }
+            entry.timings.link += Milliseconds(start);
+        }
+        entry.timings.ready = Milliseconds(entry.requested);
+        entry.state = ready ? eState::READY : eState::FAILED;
+        return;
+    }
+
+    // Compile statuses first, so waiting on the compiler and on the linker are told apart
+    Clock::time_point start = Clock::now();
+    GLint compiled = GL_FALSE;
+    for (const GLuint shader : entry.shaders)
+    {
+        if (shader != 0)
+        {
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        }
+    }
+    entry.timings.compile += Milliseconds(start);
+
+    start = Clock::now();
+    GLint linked = GL_FALSE;
+    glGetProgramiv(entry.program, GL_LINK_STATUS, &linked);
+    entry.timings.link += Milliseconds(start);
+
+    // Reflection would find none of its uniforms, the driver dropped their names: GLSL from now on
+    if (linked == GL_TRUE && (!entry.glsl[0].empty() || !entry.glsl[1].empty()) && !HasUniformNames(entry.program))
+    {
+        LOG_STDERR("Uniforms of " << entry.name << " have no names in SPIR-V, building the GLSL instead");
+        SpirvLoader::SetEnabled(false);
+        for (GLuint& shader : entry.shaders)
+        {
+            if (shader != 0)
+            {
+                glDetachShader(entry.program, shader);
+                glDeleteShader(shader);
+                shader = 0;
+            }
+        }
+        std::string codes[2];
+        codes[0].swap(entry.glsl[0]);
+        codes[1].swap(entry.glsl[1]);
+        CompileAndLink(entry, codes);
+        Finish(entry);
+        return;
+    }
+    entry.glsl[0].clear();
+    entry.glsl[1].clear();
+    entry.timings.ready = Milliseconds(entry.requested);
+
+    if (linked == GL_TRUE)
+    {
+        entry.state = eState::READY;
+        ProgramCache::Save(entry.program, entry.sourceHash);
+    }
+    else
+    {
+        // The compile logs tell which stage broke, source string numbers index the files
+        entry.state = eState::FAILED;
+        GL::CheckLinkStatus(entry.program);
+        for (const std::vector<std::string>& files : entry.files)
+        {
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                LOG_STDERR(" Source " << i << ": " << files[i]);
+            }
+        }
+        for (const GLuint shader : entry.shaders)
+        {
+            if (shader != 0)
+            {
+                GL::CheckCompileStatus(shader);
+            }
+        }
+    }
+
+    for (GLuint& shader : entry.shaders)
+    {
+        if (shader != 0)
+        {
+            glDetachShader(entry.program, shader);
+            glDeleteShader(shader);
+            shader = 0;
+        }
+    }
+}
+
+//----------------------------------------------------------------
+const bool ProgramRegistry::IsCompleted(Entry& entry)
+{
+    if (entry.state != eState::PENDING)
+    {
+        return true;
+    }
+    if (entry.stages[0] != nullptr)
+    {
+        return IsCompleted(*entry.stages[0]) && IsCompleted(*entry.stages[1]);
+    }
+    if (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile)
+    {
+        return true;
+    }
+
+    GLint completed = GL_FALSE;
+    glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+//----------------------------------------------------------------
+const bool ProgramRegistry::IsReady(Entry& entry)
+{
+    if (!IsCompleted(entry))
+    {
+        return false;
+    }
+
+    Finish(entry);
+    return entry.state == eState::READY;
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::Retain(Entry& entry)
+{
+    ++entry.refCount;
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::Release(Entry& entry)
+{
+    if (--entry.refCount > 0)
+    {
+        return;
+    }
+
+    Entry* const stages[2] = { entry.stages[0], entry.stages[1] };
+    for (const GLuint shader : entry.shaders)
+    {
+        glDeleteShader(shader);
+    }
+    if (entry.pipeline != 0)
+    {
+        GLState::DeleteProgramPipeline(entry.pipeline);
+    }
+    if (entry.program != 0)
+    {
+        GLState::DeleteProgram(entry.program);
+    }
+    mInstance.mEntries.erase(entry.sourceHash);
+
+    for (Entry* stage : stages)
+    {
+        if (stage != nullptr)
+        {
+            Release(*stage);
+        }
+    }
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::SetSeparable(const bool separable)
+{
+    mInstance.mSeparable = separable;
+}
+
+//----------------------------------------------------------------
+const bool ProgramRegistry::IsSeparable()
+{
+    return mInstance.mSeparable && (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_separate_shader_objects);
+}
+
+//----------------------------------------------------------------
+void ProgramRegistry::LogTimings()
+{
+    std::vector<const Entry*> entries;
+    for (const EntryMap::value_type& entry : mInstance.mEntries)
+    {
+        entries.push_back(entry.second.get());
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->timings.ready > b->timings.ready; });
+
+    for (const Entry* entry : entries)
+    {
+        const char* state = entry->state == eState::READY ? "" : entry->state == eState::PENDING ? " (pending)" : " (failed)";
+        LOG_STDOUT(entry->name << state << ": compile " << entry->timings.compile << " ms, link " << entry->timings.link
+                   << " ms, ready after " << entry->timings.ready << " ms, " << entry->refCount << " users");
+    }
+}
+
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,217 @@
+#include <system/include/shaderPreprocessor.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace Vision
+{
+namespace System
+{
+namespace ShaderPreprocessor
+{
+
+namespace
+{
+    static const int sMaxDepth = 32;    // Deeper include chains are taken for cycles
+
+    struct Context
+    {
+        const ShaderDefines& defines;
+        std::vector<std::string>& files;
+        std::string& code;
+        bool versioned;     // Defines added after the version line
+    };
+
+    //----------------------------------------------------------------
+    const std::string GetDefineLines(const ShaderDefines& defines)
+    {
+        std::string lines;
+        for (const ShaderDefines::value_type& define : defines)
+        {
+            // Also usable in expressions, like the specialization constants of SPIR-V variants
+            lines += "#define " + define.first + " " + (define.second.empty() ? "1" : define.second) + '\n';
+        }
+        return lines;
+    }
+
+    //----------------------------------------------------------------
+    // Directive starting the line, after spaces and the '#', or nullptr
+    const char* GetDirective(const std::string& line, const char* name)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '#')
+        {
+            return nullptr;
+        }
+        start = line.find_first_not_of(" \t", start + 1);
+        const size_t length = std::char_traits<char>::length(name);
+        if (start == std::string::npos || line.compare(start, length, name) != 0)
+        {
+            return nullptr;
+        }
+        return line.c_str() + start + length;
+    }
+
+    //----------------------------------------------------------------
+    // Path between quotes or angle brackets
+    const bool GetIncludePath(const char* arguments, std::string& path)
+    {
+        const std::string text(arguments);
+        const size_t open = text.find_first_of("\"<");
+        if (open == std::string::npos)
+        {
+            return false;
+        }
+        const size_t close = text.find(text[open] == '"' ? '"' : '>', open + 1);
+        if (close == std::string::npos)
+        {
+            return false;
+        }
+        path = text.substr(open + 1, close - open - 1);
+        return !path.empty();
+    }
+
+    //----------------------------------------------------------------
+    const bool Expand(Context& context, const std::filesystem::path& path, const int depth)
+    {
+        if (depth > sMaxDepth)
+        {
+            LOG_STDERR("Shader include chain too deep at \'" << path.string() << "\', it includes itself.");
+            return false;
+        }
+
+        std::ifstream file(path);
+        if (!file)
+        {
+            LOG_STDERR("Failed reading shader \'" << path.string() << "\'.");
+            return false;
+        }
+
+        const int source = static_cast<int>(context.files.size());
+        context.files.push_back(path.generic_string());
+
+        std::string line;
+        int number = 0;
+        while (std::getline(file, line))
+        {
+            ++number;
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            // The root file goes first, its version line is followed by the defines
+            if (GetDirective(line, "version") != nullptr)
+            {
+                if (depth == 0 && !context.versioned)
+                {
+                    context.versioned = true;
+                    context.code += line + '\n' + GetDefineLines(context.defines);
+                    context.code += "#line " + std::to_string(number + 1) + " " + std::to_string(source) + '\n';
+                }
+                else
+                {
+                    context.code += '\n';
+                }
+                continue;
+            }
+
+            if (GetDirective(line, "pragma") != nullptr && line.find("once") != std::string::npos)
+            {
+                context.code += '\n';
+                continue;
+            }
+
+            const char* include = GetDirective(line, "include");
+            if (include == nullptr)
+            {
+                context.code += line + '\n';
+                continue;
+            }
+
+            std::string name;
+            if (!GetIncludePath(include, name))
+            {
+                LOG_STDERR("Malformed include in \'" << path.string() << "\' line " << number << ".");
+                return false;
+            }
+
+            // Expanded once, where first included
+            const std::filesystem::path included = (path.parent_path() / name).lexically_normal();
+            bool expanded = false;
+            for (const std::string& previous : context.files)
+            {
+                expanded = expanded || previous == included.generic_string();
+            }
+            if (expanded)
+            {
+                context.code += '\n';
+                continue;
+            }
+
+            context.code += "#line 1 " + std::to_string(context.files.size()) + '\n';
+            if (!Expand(context, included, depth + 1))
+            {
+                return false;
+            }
+            context.code += "#line " + std::to_string(number + 1) + " " + std::to_string(source) + '\n';
+        }
+        return true;
+    }
+}
+
+//----------------------------------------------------------------
+const bool Process(const char* path, const ShaderDefines& defines, std::string& code, std::vector<std::string>* files /*= nullptr*/)
+{
+    std::vector<std::string> expanded;
+    code.clear();
+    Context context = { defines, files != nullptr ? *files : expanded, code, false };
+    context.files.clear();
+    if (!Expand(context, std::filesystem::path(path).lexically_normal(), 0))
+    {
+        return false;
+    }
+
+    // Without a version line the defines go first
+    if (!context.versioned && !defines.empty())
+    {
+        code.insert(0, GetDefineLines(defines) + "#line 1 0\n");
+    }
+    return true;
+}
+
+//----------------------------------------------------------------
+const std::string GetKey(const ShaderDefines& defines)
+{
+    std::string key;
+    for (const ShaderDefines::value_type& define : defines)
+    {
+        key += define.first + "=" + define.second + ";";
+    }
+    return key;
+}
+
+//----------------------------------------------------------------
+const bool IsDefineUsed(const std::string& code, const std::string& name)
+{
+    const size_t first = code.find(name);
+    return first != std::string::npos && code.find(name, first + name.size()) != std::string::npos;
+}
+
+//----------------------------------------------------------------
+const ShaderDefines GetUsedDefines(const std::string& code, const ShaderDefines& defines)
+{
+    ShaderDefines used;
+    for (const ShaderDefines::value_type& define : defines)
+    {
+        if (IsDefineUsed(code, define.first))
+        {
+            used.insert(define);
+        }
+    }
+    return used;
+}
+
+} // namespace ShaderPreprocessor
+} // namespace System
+} // namespace Vision
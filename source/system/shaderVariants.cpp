@@ -0,0 +1,60 @@
+#include <system/include/shaderVariants.h>
+
+namespace Vision
+{
+namespace System
+{
+
+//********************************
+//     Class ShaderVariants
+//********************************
+//----------------------------------------------------------------
+ShaderVariants::ShaderVariants()
+    : mVertexPath()
+    , mFragmentPath()
+    , mVariants()
+{}
+
+//----------------------------------------------------------------
+ShaderVariants::ShaderVariants(const char* vertexPath, const char* fragmentPath)
+    : mVertexPath(vertexPath)
+    , mFragmentPath(fragmentPath)
+    , mVariants()
+{}
+
+//----------------------------------------------------------------
+ShaderVariants::~ShaderVariants()
+{
+    for (std::pair<const std::string, Variant*>& entry : mVariants)
+    {
+        ProgramRegistry::Release(*entry.second);
+    }
+}
+
+//----------------------------------------------------------------
+ShaderVariants::Variant& ShaderVariants::Request(const ShaderDefines& defines)
+{
+    const auto found = mVariants.emplace(ShaderPreprocessor::GetKey(defines), nullptr);
+    if (found.second)
+    {
+        found.first->second = &ProgramRegistry::Request(mVertexPath.c_str(), mFragmentPath.c_str(), defines);
+    }
+    return *found.first->second;
+}
+
+//----------------------------------------------------------------
+const bool ShaderVariants::IsReady(const ShaderDefines& defines)
+{
+    return ProgramRegistry::IsReady(Request(defines));
+}
+
+//----------------------------------------------------------------
+ShaderVariants::Variant& ShaderVariants::Acquire(const ShaderDefines& defines)
+{
+    Variant& variant = Request(defines);
+    ProgramRegistry::Finish(variant);
+    return variant;
+}
+
+} // namespace System
+} // namespace Vision
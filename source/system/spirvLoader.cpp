@@ -0,0 +1,190 @@
+#include <system/include/spirvLoader.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Vision
+{
+namespace System
+{
+namespace SpirvLoader
+{
+
+namespace
+{
+    static bool sEnabled = true;
+
+    struct Constant
+    {
+        GLuint id = 0;
+        bool isFloat = false;
+        std::string name;
+    };
+
+    //----------------------------------------------------------------
+    // Declarations "constant_id = N) const type NAME" anywhere in the source
+    const std::vector<Constant> FindConstants(const std::string& code)
+    {
+        std::vector<Constant> constants;
+        for (size_t at = code.find("constant_id"); at != std::string::npos; at = code.find("constant_id", at + 1))
+        {
+            Constant constant;
+            char type[32];
+            char name[64];
+            if (std::sscanf(code.c_str() + at, "constant_id = %u ) const %31s %63[A-Za-z0-9_]", &constant.id, type, name) == 3)
+            {
+                constant.isFloat = std::strcmp(type, "float") == 0;
+                constant.name = name;
+                constants.push_back(constant);
+            }
+        }
+        return constants;
+    }
+
+    //----------------------------------------------------------------
+    // Ids and raw values of the constants set by the defines, false if one the stage uses has no constant
+    const bool Specialize(const std::string& code, const ShaderDefines& defines, std::vector<GLuint>& ids, std::vector<GLuint>& values)
+    {
+        const std::vector<Constant> constants = FindConstants(code);
+        for (const ShaderDefines::value_type& define : defines)
+        {
+            const Constant* found = nullptr;
+            for (const Constant& constant : constants)
+            {
+                found = constant.name == define.first ? &constant : found;
+            }
+            if (found == nullptr)
+            {
+                // Features of the other stage leave this one alone
+                if (ShaderPreprocessor::IsDefineUsed(code, define.first))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            GLuint value = 1;
+            if (found->isFloat)
+            {
+                const float number = define.second.empty() ? 1.0f : std::strtof(define.second.c_str(), nullptr);
+                std::memcpy(&value, &number, sizeof(value));
+            }
+            else if (!define.second.empty())
+            {
+                value = static_cast<GLuint>(std::strtol(define.second.c_str(), nullptr, 0));
+            }
+            ids.push_back(found->id);
+            values.push_back(value);
+        }
+        return true;
+    }
+
+    //----------------------------------------------------------------
+    // Built after every file the source expands
+    const bool IsCurrent(const std::filesystem::path& binary, const std::vector<std::string>& files)
+    {
+        std::error_code error;
+        const std::filesystem::file_time_type built = std::filesystem::last_write_time(binary, error);
+        if (error)
+        {
+            return false;
+        }
+        for (const std::string& file : files)
+        {
+            const std::filesystem::file_time_type written = std::filesystem::last_write_time(file, error);
+            if (error || written > built)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+//----------------------------------------------------------------
+const std::string GetBinaryPath(const char* sourcePath)
+{
+    const std::filesystem::path source(sourcePath);
+    return (source.parent_path() / sSpirvDirectory / source.stem()).string() + sSpirvExtension;
+}
+
+//----------------------------------------------------------------
+const GLuint LoadShader(const char* sourcePath, const GLenum type, const std::string& code, const std::vector<std::string>& files, const ShaderDefines& defines)
+{
+    if (!sEnabled || !IsSupported())
+    {
+        return 0;
+    }
+
+    std::vector<GLuint> ids;
+    std::vector<GLuint> values;
+    const std::string path = GetBinaryPath(sourcePath);
+    if (!Specialize(code, defines, ids, values) || !IsCurrent(path, files))
+    {
+        return 0;
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const std::streamsize size = file ? static_cast<std::streamsize>(file.tellg()) : 0;
+    std::vector<char> binary(static_cast<size_t>(size));
+    file.seekg(0);
+    if (size == 0 || size % 4 != 0 || !file.read(binary.data(), size))
+    {
+        LOG_STDERR("Invalid SPIR-V \'" << path << "\'.");
+        return 0;
+    }
+
+    GLuint shader = glCreateShader(type);
+    glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, binary.data(), static_cast<GLsizei>(size));
+    glSpecializeShaderARB(shader, "main", static_cast<GLuint>(ids.size()), ids.data(), values.data());
+
+    GLint specialized = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &specialized);
+    if (specialized != GL_TRUE)
+    {
+        GLchar infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        LOG_STDERR("Failed specializing SPIR-V \'" << path << "\', compiling the GLSL: " << infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+//----------------------------------------------------------------
+void SetEnabled(const bool enabled)
+{
+    sEnabled = enabled;
+}
+
+//----------------------------------------------------------------
+const bool IsSupported()
+{
+    if (GLAD_GL_ARB_gl_spirv == 0)
+    {
+        return false;
+    }
+
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_SHADER_BINARY_FORMATS, &count);
+    std::vector<GLint> formats(static_cast<size_t>(count > 0 ? count : 0));
+    if (!formats.empty())
+    {
+        glGetIntegerv(GL_SHADER_BINARY_FORMATS, formats.data());
+    }
+    for (const GLint format : formats)
+    {
+        if (format == GL_SHADER_BINARY_FORMAT_SPIR_V_ARB)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace SpirvLoader
+} // namespace System
+} // namespace Vision
@@ -0,0 +1,209 @@
+#include <system/include/streamBuffer.h>
+
+#include <system/include/frameStats.h>
+#include <system/include/glState.h>
+#include <algorithm>
+
+namespace Vision
+{
+namespace System
+{
+
+//********************************
+//     Class StreamBuffer
+//********************************
+//----------------------------------------------------------------
+StreamBuffer::StreamBuffer()
+    : mBuffer(0)
+    , mRegionSize(0)
+    , mRegion(0)
+    , mHead(0)
+    , mCommitted(0)
+    , mFrame(0)
+    , mMapped(nullptr)
+    , mFences()
+    , mStaging()
+    , mRetired()
+{}
+
+//----------------------------------------------------------------
+StreamBuffer::~StreamBuffer()
+{
+    // Buffers owned by statics may outlive the context
+    if (SDL_GL_GetCurrentContext() != nullptr)
+    {
+        Destroy();
+    }
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::Create(const size_t regionSize)
+{
+    Destroy();
+    Reallocate(regionSize);
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::Destroy()
+{
+    if (mBuffer != 0)
+    {
+        mRetired.push_back({ mBuffer, mMapped != nullptr, mFrame });
+        mBuffer = 0;
+        mMapped = nullptr;
+    }
+    ReleaseRetired(true);
+
+    for (GLsync& fence : mFences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    mStaging.clear();
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::Reallocate(const size_t regionSize)
+{
+    // Draws of this frame may still use the old buffer, it is deleted a few frames later
+    if (mBuffer != 0)
+    {
+        mRetired.push_back({ mBuffer, mMapped != nullptr, FrameStats::GetFrameCount() });
+    }
+
+    // The new buffer has no pending reader
+    for (GLsync& fence : mFences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    mRegionSize = regionSize;
+    mRegion = 0;
+    mHead = 0;
+    mCommitted = 0;
+    mFrame = FrameStats::GetFrameCount();
+
+    const size_t bytes = mRegionSize * sRegions;
+    glGenBuffers(1, &mBuffer);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+    if (GLAD_GL_ARB_buffer_storage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, bytes, nullptr, flags);
+        mMapped = static_cast<std::uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bytes, flags));
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        mMapped = nullptr;
+        mStaging.assign(bytes, 0);
+    }
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::ReleaseRetired(const bool all)
+{
+    const size_t frame = FrameStats::GetFrameCount();
+    for (auto retired = mRetired.begin(); retired != mRetired.end();)
+    {
+        if (!all && frame <= retired->frame + sRegions)
+        {
+            ++retired;
+            continue;
+        }
+
+        if (retired->mapped)
+        {
+            GLState::BindBuffer(GL_COPY_WRITE_BUFFER, retired->buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        GLState::DeleteBuffer(retired->buffer);
+        retired = mRetired.erase(retired);
+    }
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::Advance()
+{
+    // Everything reading the current region was issued during its frame
+    if (mHead > 0)
+    {
+        mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mRegion = (mRegion + 1) % sRegions;
+    }
+    mHead = 0;
+    mCommitted = 0;
+    mFrame = FrameStats::GetFrameCount();
+
+    GLsync& fence = mFences[mRegion];
+    if (fence != nullptr)
+    {
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            FrameStats::AddStreamStall();
+            while (status == GL_TIMEOUT_EXPIRED)
+            {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            }
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    ReleaseRetired(false);
+}
+
+//----------------------------------------------------------------
+const StreamBuffer::Allocation StreamBuffer::Allocate(const size_t bytes, const size_t alignment /*= 4*/)
+{
+    assert(mBuffer != 0 && (alignment & (alignment - 1)) == 0);
+
+    if (mFrame != FrameStats::GetFrameCount())
+    {
+        Advance();
+    }
+
+    // Offsets are aligned from the region base, so the region size must be a multiple too
+    size_t start = (mHead + alignment - 1) & ~(alignment - 1);
+    const bool full = start + bytes > mRegionSize;
+    if (full || (mRegionSize & (alignment - 1)) != 0)
+    {
+        Commit();
+        const size_t regionSize = full ? std::max(mRegionSize * 2, bytes) : mRegionSize;
+        Reallocate((regionSize + alignment - 1) & ~(alignment - 1));
+        start = 0;
+    }
+    mHead = start + bytes;
+
+    Allocation allocation;
+    allocation.offset = static_cast<GLintptr>(mRegion * mRegionSize + start);
+    allocation.size = static_cast<GLsizeiptr>(bytes);
+    allocation.data = (mMapped != nullptr ? mMapped : mStaging.data()) + allocation.offset;
+    FrameStats::AddStream(bytes);
+    return allocation;
+}
+
+//----------------------------------------------------------------
+void StreamBuffer::Commit()
+{
+    if (mMapped != nullptr || mHead == mCommitted)
+    {
+        return;
+    }
+
+    const size_t offset = mRegion * mRegionSize + mCommitted;
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, mHead - mCommitted, mStaging.data() + offset);
+    mCommitted = mHead;
+}
+
+} // namespace System
+} // namespace Vision
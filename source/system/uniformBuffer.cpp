@@ -0,0 +1,79 @@
+#include <system/include/uniformBuffer.h>
+
+#include <sstream>
+
+namespace Vision
+{
+namespace System
+{
+
+//----------------------------------------------------------------
+const std::string GetBlockDeclaration(const char* blockName, const GLuint binding, const std::vector<Std140Field>& fields)
+{
+    std::ostringstream declaration;
+    declaration << "layout (std140, binding = " << binding << ") uniform " << blockName << "\n{\n";
+    for (const Std140Field& field : fields)
+    {
+        declaration << "\t" << field.glslType << " " << field.name << ";\n";
+    }
+    declaration << "};\n";
+    return declaration.str();
+}
+
+//----------------------------------------------------------------
+const bool CheckUniformBlock(const GLuint program, const char* blockName, const GLuint binding, const std::vector<Std140Field>& fields)
+{
+    const GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+    if (blockIndex == GL_INVALID_INDEX)
+    {
+        return true;
+    }
+
+    // Shaders without a binding qualifier get theirs here
+    glUniformBlockBinding(program, blockIndex, binding);
+
+    GLint memberCount = 0;
+    glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &memberCount);
+
+    bool matches = memberCount <= static_cast<GLint>(fields.size());
+    for (const Std140Field& field : fields)
+    {
+        // Members unused by the shaders may be reported inactive, only placed ones are compared
+        const GLchar* name = field.name.c_str();
+        GLuint index = GL_INVALID_INDEX;
+        glGetUniformIndices(program, 1, &name, &index);
+        if (index == GL_INVALID_INDEX)
+        {
+            continue;
+        }
+
+        GLint offset = -1;
+        GLint memberBlock = -1;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &offset);
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &memberBlock);
+        matches = matches && memberBlock == static_cast<GLint>(blockIndex) && offset == static_cast<GLint>(field.offset);
+    }
+
+    if (!matches)
+    {
+        LOG_STDERR("Uniform block " << blockName << " doesn't match its C++ layout, expected:\n" << GetBlockDeclaration(blockName, binding, fields));
+    }
+    return matches;
+}
+
+//********************************
+//     Struct FrameUniforms
+//********************************
+//----------------------------------------------------------------
+const Std140Layout<FrameUniforms>& FrameUniforms::GetLayout()
+{
+    static const Std140Layout<FrameUniforms> layout = Std140Layout<FrameUniforms>()
+        .Add("view", &FrameUniforms::view)
+        .Add("projection", &FrameUniforms::projection)
+        .Add("viewProjection", &FrameUniforms::viewProjection)
+        .Add("cameraPosition", &FrameUniforms::cameraPosition);
+    return layout;
+}
+
+} // namespace System
+} // namespace Vision
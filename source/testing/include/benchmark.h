@@ -0,0 +1,558 @@
+#pragma once
+
+#include <common/include/common.h>
+#include <graphic/include/blockCompression.h>
+#include <graphic/include/bvh.h>
+#include <graphic/include/frustum.h>
+#include <graphic/include/occlusion.h>
+#include <graphic/include/spatialIndex.h>
+#include <graphic/include/textureCook.h>
+#include <system/include/types.h>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Vision
+{
+namespace Testing
+{
+namespace Benchmark
+{
+	using Vector = System::Types::Vector3;
+
+	// Milliseconds per call of the function, averaged over the repeats
+	static const double Measure(const std::function<void()>& function, const int repeats)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; ++i)
+		{
+			function();
+		}
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / repeats;
+	}
+
+	/**
+	 * @brief Compares linear scans with the BVH on scenes of growing size.
+	 *
+	 * Objects are unit sized boxes spread with a constant density, so bigger scenes are mostly
+	 * outside the view of a camera at their center. Queries per row: one frustum, 100 spheres,
+	 * 100 boxes and 100 rays; refit moves 1% of the objects.
+	 */
+	static void RunSpatialIndex()
+	{
+		static const int sQueries = 100;
+
+		LOG_STDOUT("objects | build ms | refit ms | frustum scan/tree ms | sphere scan/tree ms | box scan/tree ms | ray scan/tree ms");
+		for (const size_t count : { 1000u, 10000u, 100000u, 1000000u })
+		{
+			std::mt19937 random(static_cast<unsigned int>(count));
+			const float side = 8.0f * std::cbrt(static_cast<float>(count));
+			std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+			std::uniform_real_distribution<float> size(0.25f, 1.0f);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+			std::vector<Graphic::Bounds> objects(count);
+			for (Graphic::Bounds& bounds : objects)
+			{
+				const Vector center(position(random), position(random), position(random));
+				bounds.Grow(center - Vector(size(random)));
+				bounds.Grow(center + Vector(size(random)));
+			}
+
+			std::vector<Vector> points(sQueries);
+			std::vector<Vector> directions(sQueries);
+			for (int i = 0; i < sQueries; ++i)
+			{
+				points[i] = Vector(position(random), position(random), position(random));
+				directions[i] = glm::normalize(Vector(unit(random), unit(random), unit(random)) + Vector(0.0f, 0.0f, 0.001f));
+			}
+
+			const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 700.0f);
+			const Graphic::Frustum frustum(projection * glm::lookAt(Vector(0.0f), Vector(0.0f, 0.0f, -1.0f), System::Types::VECTOR_UP));
+			std::vector<std::uint32_t> found;
+			const int repeats = count >= 1000000 ? 2 : 10;
+
+			Graphic::BVH tree;
+			const double build = Measure([&]()
+			{
+				tree.Clear();
+				for (std::uint32_t i = 0; i < count; ++i)
+				{
+					tree.Insert(i, objects[i]);
+				}
+				tree.Refresh();
+			}, repeats);
+
+			// A hundredth of the objects move by a small step, few enough to be refitted
+			const double refit = Measure([&]()
+			{
+				for (std::uint32_t i = 0; i < count; i += 100)
+				{
+					const Vector step(unit(random) * 0.1f);
+					Graphic::Bounds moved = tree.GetBounds(i);
+					moved.min += step;
+					moved.max += step;
+					tree.Move(i, moved);
+				}
+				tree.Refresh();
+			}, repeats);
+
+			Graphic::FrustumCuller culler;
+			culler.Resize(count);
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				culler.Set(i, tree.GetBounds(i), i);
+			}
+			size_t scanVisible = 0;
+			size_t treeVisible = 0;
+			const double frustumScan = Measure([&]() { scanVisible = culler.Cull(frustum).size(); }, repeats);
+			const double frustumTree = Measure([&]() { found.clear(); tree.QueryFrustum(frustum, found); treeVisible = found.size(); }, repeats);
+
+			const double sphereScan = Measure([&]()
+			{
+				found.clear();
+				for (const Vector& center : points)
+				{
+					for (std::uint32_t i = 0; i < count; ++i)
+					{
+						const Graphic::Bounds& bounds = tree.GetBounds(i);
+						const Vector outside = glm::max(glm::max(bounds.min - center, center - bounds.max), Vector(0.0f));
+						if (glm::dot(outside, outside) <= 16.0f)
+						{
+							found.push_back(i);
+						}
+					}
+				}
+			}, 1);
+			const double sphereTree = Measure([&]()
+			{
+				found.clear();
+				for (const Vector& center : points)
+				{
+					tree.QuerySphere(center, 4.0f, found);
+				}
+			}, repeats);
+
+			const double boxScan = Measure([&]()
+			{
+				found.clear();
+				for (const Vector& center : points)
+				{
+					const Vector low = center - Vector(4.0f);
+					const Vector high = center + Vector(4.0f);
+					for (std::uint32_t i = 0; i < count; ++i)
+					{
+						const Graphic::Bounds& bounds = tree.GetBounds(i);
+						if (glm::all(glm::lessThanEqual(bounds.min, high)) && glm::all(glm::greaterThanEqual(bounds.max, low)))
+						{
+							found.push_back(i);
+						}
+					}
+				}
+			}, 1);
+			const double boxTree = Measure([&]()
+			{
+				found.clear();
+				for (const Vector& center : points)
+				{
+					Graphic::Bounds query;
+					query.Grow(center - Vector(4.0f));
+					query.Grow(center + Vector(4.0f));
+					tree.QueryBounds(query, found);
+				}
+			}, repeats);
+
+			// The scan keeps the closest box entered, like the tree
+			float scanDistances = 0.0f;
+			float treeDistances = 0.0f;
+			const double rayScan = Measure([&]()
+			{
+				scanDistances = 0.0f;
+				for (int ray = 0; ray < sQueries; ++ray)
+				{
+					const Vector inverse = 1.0f / directions[ray];
+					float closest = side;
+					for (std::uint32_t i = 0; i < count; ++i)
+					{
+						const Graphic::Bounds& bounds = tree.GetBounds(i);
+						const Vector toMin = (bounds.min - points[ray]) * inverse;
+						const Vector toMax = (bounds.max - points[ray]) * inverse;
+						const Vector entry = glm::min(toMin, toMax);
+						const Vector exit = glm::max(toMin, toMax);
+						const float enter = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+						const float leave = std::min(std::min(exit.x, exit.y), std::min(exit.z, closest));
+						closest = enter <= leave ? enter : closest;
+					}
+					scanDistances += closest;
+				}
+			}, 1);
+			const double rayTree = Measure([&]()
+			{
+				Graphic::BVH::RayHit hit;
+				treeDistances = 0.0f;
+				for (int ray = 0; ray < sQueries; ++ray)
+				{
+					treeDistances += tree.Raycast(points[ray], directions[ray], side, hit) ? hit.distance : side;
+				}
+			}, repeats);
+
+			LOG_STDOUT(std::fixed << std::setprecision(3) << count << " | " << build << " | " << refit
+				<< " | " << frustumScan << "/" << frustumTree << " (" << scanVisible << "/" << treeVisible << " visible)"
+				<< " | " << sphereScan << "/" << sphereTree << " | " << boxScan << "/" << boxTree << " | " << rayScan << "/" << rayTree << " (" << scanDistances << "/" << treeDistances << " summed distances)");
+		}
+	}
+
+	/**
+	 * @brief Compares the spatial structures on objects that all move every frame.
+	 *
+	 * A frame moves every object by its velocity, bouncing off the scene borders, then culls
+	 * the scene with a frustum, as GenDrawingInfo would.
+	 */
+	static void RunDynamicObjects()
+	{
+		static const int sFrames = 10;
+
+		LOG_STDOUT("moving objects | bvh update/frustum ms | grid update/frustum ms");
+		for (const size_t count : { 1000u, 10000u, 100000u })
+		{
+			std::mt19937 random(static_cast<unsigned int>(count));
+			const float side = 8.0f * std::cbrt(static_cast<float>(count));
+			std::uniform_real_distribution<float> position(-side * 0.5f, side * 0.5f);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+			std::vector<Vector> centers(count);
+			std::vector<Vector> velocities(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				centers[i] = Vector(position(random), position(random), position(random));
+				velocities[i] = Vector(unit(random), unit(random), unit(random)) * 0.5f;
+			}
+
+			const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 700.0f);
+			const Graphic::Frustum frustum(projection * glm::lookAt(Vector(0.0f), Vector(0.0f, 0.0f, -1.0f), System::Types::VECTOR_UP));
+
+			double update[2] = {};
+			double query[2] = {};
+			size_t visible[2] = {};
+			const Graphic::eSpatialStructure structures[2] = { Graphic::eSpatialStructure::BVH, Graphic::eSpatialStructure::GRID };
+			for (int structure = 0; structure < 2; ++structure)
+			{
+				std::unique_ptr<Graphic::ISpatialIndex> index = Graphic::CreateSpatialIndex(structures[structure]);
+				std::vector<Vector> frameCenters = centers;
+				std::vector<Vector> frameVelocities = velocities;
+				for (std::uint32_t i = 0; i < count; ++i)
+				{
+					Graphic::Bounds bounds;
+					bounds.Grow(frameCenters[i] - Vector(0.5f));
+					bounds.Grow(frameCenters[i] + Vector(0.5f));
+					index->Insert(i, bounds);
+				}
+				index->Refresh();
+
+				std::vector<std::uint32_t> found;
+				for (int frame = 0; frame < sFrames; ++frame)
+				{
+					update[structure] += Measure([&]()
+					{
+						for (std::uint32_t i = 0; i < count; ++i)
+						{
+							Vector& center = frameCenters[i];
+							Vector& velocity = frameVelocities[i];
+							center += velocity;
+							velocity = glm::mix(velocity, -velocity, glm::vec3(glm::greaterThan(glm::abs(center), Vector(side * 0.5f))));
+
+							Graphic::Bounds bounds;
+							bounds.Grow(center - Vector(0.5f));
+							bounds.Grow(center + Vector(0.5f));
+							index->Move(i, bounds);
+						}
+						index->Refresh();
+					}, 1) / sFrames;
+					query[structure] += Measure([&]() { found.clear(); index->QueryFrustum(frustum, found); visible[structure] = found.size(); }, 1) / sFrames;
+				}
+			}
+
+			LOG_STDOUT(std::fixed << std::setprecision(3) << count << " | " << update[0] << "/" << query[0] << " | " << update[1] << "/" << query[1]
+				<< " (" << visible[0] << "/" << visible[1] << " visible)");
+		}
+	}
+
+	// Appends a box to vertices laid out like GraphicData, two triangles per face
+	static void AddBox(const Graphic::Bounds& bounds, System::Types::VertexVector& vertices, System::Types::IndexVector& indices)
+	{
+		const System::Types::UInt first = static_cast<System::Types::UInt>(vertices.size() / System::Types::VertexConst::SIZE);
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			vertices.insert(vertices.end(), { corner & 1 ? bounds.max.x : bounds.min.x, corner & 2 ? bounds.max.y : bounds.min.y, corner & 4 ? bounds.max.z : bounds.min.z,
+				1.0f, 1.0f, 1.0f, 0.0f, 0.0f });
+		}
+		for (const System::Types::UInt index : { 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5 })
+		{
+			indices.push_back(first + index);
+		}
+	}
+
+	/**
+	 * @brief Occlusion culling of objects in a city, seen from a street.
+	 *
+	 * Buildings are the occluders and small objects are spread over the blocks. Objects in the
+	 * frustum are tested against the depth of the buildings in view; rasterize covers the
+	 * whole depth buffer pass, from Begin to the pyramid.
+	 */
+	static void RunOcclusion()
+	{
+		static const int sBlocks = 20;
+		static const float sBlockSize = 16.0f;
+		static const float sStreetWidth = 6.0f;
+
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> height(10.0f, 40.0f);
+		System::Types::VertexVector vertices;
+		System::Types::IndexVector indices;
+		const float cityHalf = sBlocks * sBlockSize * 0.5f;
+		for (int x = 0; x < sBlocks; ++x)
+		{
+			for (int z = 0; z < sBlocks; ++z)
+			{
+				Graphic::Bounds building;
+				building.Grow(Vector(x * sBlockSize - cityHalf + sStreetWidth * 0.5f, 0.0f, z * sBlockSize - cityHalf + sStreetWidth * 0.5f));
+				building.Grow(Vector((x + 1) * sBlockSize - cityHalf - sStreetWidth * 0.5f, height(random), (z + 1) * sBlockSize - cityHalf - sStreetWidth * 0.5f));
+				AddBox(building, vertices, indices);
+			}
+		}
+
+		// At eye height on the street between the two middle columns of blocks, looking down it at an angle
+		const Vector eye(0.0f, 1.8f, cityHalf * 0.5f);
+		const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 800.0f / 600.0f, 0.1f, 700.0f);
+		const glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + Vector(0.3f, 0.0f, -1.0f), System::Types::VECTOR_UP);
+		const Graphic::Frustum frustum(viewProjection);
+
+		LOG_STDOUT("objects | rasterize ms | test ms | in frustum | not occluded");
+		for (const size_t count : { 10000u, 100000u })
+		{
+			std::uniform_real_distribution<float> position(-cityHalf, cityHalf);
+			std::uniform_real_distribution<float> up(0.0f, 3.0f);
+			std::vector<Graphic::Bounds> objects(count);
+			for (Graphic::Bounds& bounds : objects)
+			{
+				const Vector center(position(random), up(random), position(random));
+				bounds.Grow(center - Vector(0.5f));
+				bounds.Grow(center + Vector(0.5f));
+			}
+
+			std::vector<std::uint32_t> inFrustum;
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				if (frustum.Intersects(objects[i]))
+				{
+					inFrustum.push_back(i);
+				}
+			}
+
+			Graphic::OcclusionCuller culler;
+			const double rasterize = Measure([&]()
+			{
+				culler.Begin(viewProjection);
+				culler.AddOccluder(vertices, indices, glm::mat4(1.0f));
+				culler.Rasterize();
+			}, 10);
+
+			size_t visible = 0;
+			const double test = Measure([&]()
+			{
+				visible = 0;
+				for (const std::uint32_t index : inFrustum)
+				{
+					visible += culler.IsVisible(objects[index]) ? 1 : 0;
+				}
+			}, 10);
+
+			LOG_STDOUT(std::fixed << std::setprecision(3) << count << " | " << rasterize << " | " << test << " | " << inFrustum.size() << " | " << visible
+				<< " (" << culler.GetTriangleCount() << " occluder triangles)");
+		}
+	}
+
+	/**
+	 * @brief Checks the occlusion culler against a wall whose depth and hidden boxes are known.
+	 *
+	 * The wall faces the camera and covers the whole screen, so every depth texel must hold the
+	 * depth of its plane, whichever SIMD path rasterized it. Then random boxes on screen are
+	 * tested: those with a part in front of the wall must all be visible (culling is
+	 * conservative), and the share of the ones fully behind it that get culled is reported.
+	 *
+	 * @return False if a check failed, the failures are logged.
+	 */
+	static const bool CheckOcclusion()
+	{
+		static const float sWallNear = 50.0f;
+		static const float sWallFar = 51.0f;
+		static const size_t sBoxes = 100000;
+
+		System::Types::VertexVector vertices;
+		System::Types::IndexVector indices;
+		Graphic::Bounds wall;
+		wall.Grow(Vector(-1000.0f, -1000.0f, -sWallFar));
+		wall.Grow(Vector(1000.0f, 1000.0f, -sWallNear));
+		AddBox(wall, vertices, indices);
+
+		// Looking down -z from the origin, with the aspect of the depth buffer
+		const glm::mat4 projection = glm::perspective(glm::radians(60.0f), float(Graphic::OcclusionCuller::sWidth) / Graphic::OcclusionCuller::sHeight, 0.1f, 200.0f);
+		Graphic::OcclusionCuller culler;
+		culler.Begin(projection);
+		culler.AddOccluder(vertices, indices, glm::mat4(1.0f));
+		culler.Rasterize();
+
+		bool passed = true;
+		const glm::vec4 wallClip = projection * glm::vec4(0.0f, 0.0f, -sWallNear, 1.0f);
+		const float wallDepth = wallClip.z / wallClip.w * 0.5f + 0.5f;
+		size_t wrongDepth = 0;
+		for (const float depth : culler.GetDepth())
+		{
+			wrongDepth += std::fabs(depth - wallDepth) > 1e-5f ? 1 : 0;
+		}
+		if (wrongDepth != 0)
+		{
+			LOG_STDERR("Occlusion: " << wrongDepth << " depth texels differ from the wall depth " << wallDepth);
+			passed = false;
+		}
+
+		// Centers well inside the screen, so every box is at least partly on it
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> distance(2.0f, 100.0f);
+		std::uniform_real_distribution<float> across(-0.8f, 0.8f);
+		std::uniform_real_distribution<float> size(0.05f, 1.0f);
+		const float tanY = std::tan(glm::radians(30.0f));
+		const float tanX = tanY * Graphic::OcclusionCuller::sWidth / Graphic::OcclusionCuller::sHeight;
+		size_t inFront = 0, culledInFront = 0, behind = 0, culledBehind = 0;
+		for (size_t i = 0; i < sBoxes; ++i)
+		{
+			const float z = distance(random);
+			const Vector center(across(random) * tanX * z, across(random) * tanY * z, -z);
+			const float half = size(random);
+			Graphic::Bounds box;
+			box.Grow(center - Vector(half));
+			box.Grow(center + Vector(half));
+
+			const bool visible = culler.IsVisible(box);
+			if (box.max.z > -sWallNear)
+			{
+				++inFront;
+				culledInFront += visible ? 0 : 1;
+			}
+			else if (box.max.z < -sWallFar)
+			{
+				++behind;
+				culledBehind += visible ? 0 : 1;
+			}
+		}
+		if (culledInFront != 0)
+		{
+			LOG_STDERR("Occlusion: " << culledInFront << " of " << inFront << " boxes in front of the wall were culled");
+			passed = false;
+		}
+
+		LOG_STDOUT("occlusion check " << (passed ? "passed" : "FAILED") << ": " << inFront << " boxes in front all visible, "
+			<< culledBehind << " of " << behind << " boxes behind culled");
+		return passed;
+	}
+
+	/**
+	 * @brief Encodes the sample images in every block format and checks their quality.
+	 *
+	 * Each image is decoded back on the CPU and compared with its source; the PSNR must reach
+	 * the quality floor TextureCook keeps compressed textures above. Color only for BC1, which
+	 * has no alpha. A gradient with varying alpha is added to the samples to cover BC3 and BC7.
+	 *
+	 * @return False if an image fell below the floor or could not be read, the failures are logged.
+	 */
+	static const bool CheckBlockCompression()
+	{
+		struct Image
+		{
+			std::string name;
+			int width;
+			int height;
+			std::vector<unsigned char> rgba;
+		};
+		std::vector<Image> images;
+
+		for (const char* path : { "texture/grassPattern.jpg" })
+		{
+			Image image = { path, 0, 0, {} };
+			int channels = 0;
+			unsigned char* data = stbi_load(path, &image.width, &image.height, &channels, 4);
+			if (data == NULL)
+			{
+				LOG_STDERR("Block compression: failed reading " << path);
+				return false;
+			}
+			image.rgba.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
+			stbi_image_free(data);
+			images.push_back(std::move(image));
+		}
+
+		Image gradient = { "gradient", 256, 256, std::vector<unsigned char>(256 * 256 * 4) };
+		for (int y = 0; y < gradient.height; ++y)
+		{
+			for (int x = 0; x < gradient.width; ++x)
+			{
+				unsigned char* texel = &gradient.rgba[(y * gradient.width + x) * 4];
+				texel[0] = static_cast<unsigned char>(x);
+				texel[1] = static_cast<unsigned char>(y);
+				texel[2] = static_cast<unsigned char>((x + y) / 2);
+				texel[3] = static_cast<unsigned char>(255 - y);
+			}
+		}
+		images.push_back(std::move(gradient));
+
+		using Format = System::Types::eTextureFormat;
+		const double floor = Graphic::TextureCook::Settings().minPSNR;
+		bool passed = true;
+		LOG_STDOUT("image | format | encode ms | PSNR dB (floor " << floor << ")");
+		for (const Image& image : images)
+		{
+			const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+			std::vector<unsigned char> decoded(pixelCount * 4);
+			for (const Format format : { Format::BC1, Format::BC3, Format::BC7 })
+			{
+				std::vector<unsigned char> blocks(Graphic::BlockCompression::ImageBytes(format, image.width, image.height));
+				const double encode = Measure([&]()
+				{
+					Graphic::BlockCompression::Encode(image.rgba.data(), image.width, image.height, format, blocks.data());
+				}, 1);
+				Graphic::BlockCompression::Decode(blocks.data(), image.width, image.height, format, decoded.data());
+
+				const double psnr = Graphic::BlockCompression::PSNR(image.rgba.data(), decoded.data(), pixelCount, format == Format::BC1);
+				const char* name = format == Format::BC1 ? "BC1" : format == Format::BC3 ? "BC3" : "BC7";
+				LOG_STDOUT(std::fixed << std::setprecision(3) << image.name << " | " << name << " | " << encode << " | " << std::setprecision(2) << psnr);
+				if (psnr < floor)
+				{
+					LOG_STDERR("Block compression: " << image.name << " in " << name << " is below the quality floor");
+					passed = false;
+				}
+			}
+		}
+		return passed;
+	}
+} //namespace Benchmark
+
+// Benchmarks, then checks; non-zero if a check failed
+const int RunBenchmarks()
+{
+	Benchmark::RunSpatialIndex();
+	Benchmark::RunDynamicObjects();
+	Benchmark::RunOcclusion();
+
+	bool passed = Benchmark::CheckOcclusion();
+	passed = Benchmark::CheckBlockCompression() && passed;
+	return passed ? 0 : 1;
+}
+
+} //namespace Testing
+} //namespace Vision
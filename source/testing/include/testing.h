@@ -1,9 +1,11 @@
 #pragma once
 
 #include <common/include/common.h>
+#include <system/include/frameStats.h>
 #include <system/include/moduleSDL.h>
 #include <system/include/moduleOpenGL.h>
 #include <system/include/types.h>
+#include <system/include/uniformBuffer.h>
 #include <graphic/include/graphic.h>
 #include <scenario.h>
 
@@ -60,8 +62,7 @@ class TestInstance
 	System::Window* mWindow;
 	Scenario::Scenario mScenario;
 
-	glm::mat4 mModel = glm::identity<glm::mat4>();
-	glm::mat4 mProjection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 700.0f);
+	System::UniformBuffer<System::FrameUniforms> mFrameBuffer = System::UniformBuffer<System::FrameUniforms>(System::FrameUniforms::GetLayout(), System::FrameUniforms::sBinding);
 
 	TestInstance() : mScenario()
 	{}
@@ -75,6 +76,7 @@ public:
 		mInstance.mWindow = new System::Window(800, 600, "Vision - Debug - Test Window");
 		
 		mInstance.NewProgram("shaders\\default_vs.glsl", "shaders\\default_fs.glsl");
+		mInstance.mFrameBuffer.Create();
 	}
 
 	static void Terminate()
@@ -110,13 +112,24 @@ public:
 			{
 				mInstance.mScenario.SetAllBuffers(defaultShader.GetVertexBufferID(), defaultShader.GetElementArrayBufferID());
 
-				defaultShader.SetMatrix4f("view", mInstance.mScenario.GetCurrentCameraView());
-				defaultShader.SetMatrix4f("projection", mInstance.mProjection);
-				defaultShader.SetMatrix4f("model", mInstance.mModel);
+				// Written once per frame, read by every program
+				System::FrameUniforms frame;
+				frame.view = mInstance.mScenario.GetCurrentCameraView();
+				frame.projection = camera.GetProjection();
+				frame.viewProjection = frame.projection * frame.view;
+				frame.cameraPosition = camera.GetPosition();
+				mInstance.mFrameBuffer.Update(frame);
 				defaultShader.Draw(mInstance.mScenario.GetDrawingInfo());
 
 				mInstance.mWindow->Swap();
 
+				System::FrameStats::EndFrame();
+				const System::FrameStats::Counters& stats = System::FrameStats::GetLastFrame();
+				if (stats.bytesUploaded > 0)
+				{
+					LOG_STDOUT("Frame " << System::FrameStats::GetFrameCount() << " uploaded " << stats.bytesUploaded << " bytes in " << stats.bufferUploads << " buffers.");
+				}
+
 				mInstance.mScenario.GetCurrentCamera();
 			}
 			refresh = true;